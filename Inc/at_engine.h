@@ -0,0 +1,116 @@
+#ifndef AT_ENGINE_H_
+#define AT_ENGINE_H_
+
+#include "sim7600e.h"   // AtResponseStatus_t
+#include "uart.h"
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#define AT_ENGINE_QUEUE_LEN 4       // Commands waiting behind the active one
+#define AT_TRANSCRIPT_SIZE  1024    // Last commands and responses kept for the console (bytes)
+#define AT_URC_HANDLERS_MAX 8       // Registered unsolicited result code handlers
+#define AT_RESP_ARENA_SIZE  256     // Bytes for the information lines of one response (incl. terminators)
+#define AT_RESP_LINES_MAX   8       // Information lines per response
+#define AT_STATS_TYPES_MAX  16      // Command types with a latency histogram
+#define AT_STATS_NAME_LEN   16      // Command type name (incl. terminator), e.g. "+CREG"
+#define AT_STATS_BUCKETS    16      // Bucket 0: < 1 ms, bucket n: 2^(n-1) .. 2^n - 1 ms, last: open ended
+
+// One part of a command (e.g. constant prefix, user string, constant suffix)
+typedef struct {
+    const char *base;
+    size_t len;
+} at_iovec_t;
+
+// Command part from a string literal (length known at compile time)
+#define AT_LIT(s)   { (s), sizeof(s) - 1 }
+
+// Command part from a run-time string
+static inline at_iovec_t at_str(const char *s)
+{
+    at_iovec_t part = { s, (s != NULL) ? strlen(s) : 0 };
+    return part;
+}
+
+typedef enum {
+    AT_CMD_IDLE = 0,    // Never submitted
+    AT_CMD_PENDING,     // Queued or running
+    AT_CMD_DONE,        // Finished, status is valid
+} at_cmd_state_t;
+
+// One information line of a response (null-terminated, stored in the arena)
+typedef struct {
+    const char *text;
+    uint16_t len;
+    AtResponseStatus_t status;      // Classification of the line
+} at_line_t;
+
+// Response of a command: the information lines and the final result code.
+// Lines that do not fit into the arena or the line table are counted, not stored.
+typedef struct {
+    char arena[AT_RESP_ARENA_SIZE];
+    uint16_t used;
+    at_line_t lines[AT_RESP_LINES_MAX];
+    uint8_t count;
+    uint8_t dropped;                // Lines that did not fit
+    AtResponseStatus_t final;       // OK, ERROR, ... or AT_TIMEOUT / AT_TX_FAILURE
+} at_resp_t;
+
+// Latency histogram and outcome counts of one command type (TX start to the final result)
+typedef struct {
+    char name[AT_STATS_NAME_LEN];
+    uint32_t buckets[AT_STATS_BUCKETS];
+    uint32_t ok;                    // Final result OK (or the awaited line)
+    uint32_t error;                 // ERROR, +CME/+CMS ERROR, NO CARRIER
+    uint32_t timeout;               // No final result in time (incl. TX failures)
+    uint32_t max_ms;
+    uint32_t timeout_ms;            // Timeout of the last command of this type
+} at_stats_t;
+
+typedef struct at_cmd at_cmd_t;
+
+// Called from at_engine_poll() when a command has finished. May submit further commands.
+typedef void (*at_callback_t)(at_cmd_t *cmd, void *ctx);
+
+// Classifies one response line (without terminator)
+typedef AtResponseStatus_t (*at_classify_t)(const char *line, size_t len);
+
+// Receives an unsolicited line (without terminator), valid during the call only
+typedef void (*at_urc_handler_t)(const char *line, size_t len, void *ctx);
+
+// A command request. The caller owns the object (and everything it points to)
+// until the command is done; zero-initialize it before the first submission.
+struct at_cmd {
+    // Request
+    const at_iovec_t *parts;        // Command text, may be empty for a wait-only request
+    size_t count;
+    uint32_t timeout_ms;            // From the start of the transmission
+    AtResponseStatus_t wait_for;    // AT_RX_PARTIAL: until the final result code, else until a line of this status
+    at_resp_t *resp;                // Receives the information lines, may be NULL
+    at_callback_t callback;         // Optional
+    void *ctx;
+    uint8_t debug;
+    uint8_t raw;                    // 1: payload data (e.g. HTTP body), neither printed nor recorded
+
+    // Result
+    volatile at_cmd_state_t state;
+    AtResponseStatus_t status;      // Final result; on OK the first information status, if any
+
+    // Engine internal
+    uint32_t start_ms;
+    AtResponseStatus_t info;
+};
+
+void at_engine_init(uart_port_t port, at_classify_t classify);
+int at_engine_register_urc(const char *prefix, at_urc_handler_t handler, void *ctx);
+int at_engine_submit(at_cmd_t *cmd);
+void at_engine_poll(void);
+AtResponseStatus_t at_engine_execute(at_cmd_t *cmd);
+int at_engine_busy(void);
+void at_engine_flush_rx(void);
+void at_engine_print_transcript(void);
+const char *at_resp_find(const at_resp_t *resp, AtResponseStatus_t status);
+void at_engine_reset_stats(void);
+void at_engine_print_stats(void);
+
+#endif  // AT_ENGINE_H_
@@ -0,0 +1,30 @@
+#ifndef AT_FRAMER_H_
+#define AT_FRAMER_H_
+
+#include "uart.h"
+#include <stdint.h>
+#include <stddef.h>
+
+#define AT_FRAMER_LINE_MAX  256     // Longest line kept in full, longer lines are truncated
+
+/*
+  Incremental CR/LF line framer on top of a UART RX ring buffer.
+
+  Complete lines are handed out as (ptr, len) slices without the line terminator.
+  A line that lies contiguously in the ring buffer is returned in place; only lines
+  that wrap around the end of the ring buffer are assembled in the scratch buffer.
+  Empty lines (the "\r\n" framing of V.250 responses) are skipped.
+*/
+typedef struct {
+    uart_port_t port;
+    char line[AT_FRAMER_LINE_MAX];  // Scratch buffer for wrapped lines
+    size_t len;                     // Bytes collected in the scratch buffer
+    size_t pending;                 // Bytes of the last in-place slice, consumed on the next call
+    uint8_t truncated;              // The line in the scratch buffer exceeded AT_FRAMER_LINE_MAX
+} at_framer_t;
+
+void at_framer_init(at_framer_t *framer, uart_port_t port);
+int at_framer_next(at_framer_t *framer, const char **line, size_t *len);
+void at_framer_flush(at_framer_t *framer);
+
+#endif  // AT_FRAMER_H_
@@ -0,0 +1,29 @@
+#ifndef AT_TOK_H_
+#define AT_TOK_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define AT_TOK_IPV4_MAX_LEN 16  // "255.255.255.255" + '\0'
+
+// Cursor over the comma-separated fields of one response line, e.g. "+CREG: 0,1".
+// Works in place on the response: nothing is copied or allocated.
+typedef struct {
+    const char *pos;    // Start of the next field
+    const char *end;    // End of the line (CR, LF or '\0')
+    uint8_t done;       // All fields consumed
+} at_tok_t;
+
+int at_tok_start(at_tok_t *tok, const char *response, const char *prefix);
+int at_tok_next(at_tok_t *tok, const char **field, size_t *len);
+int at_tok_int(at_tok_t *tok, int *value);
+int at_tok_str(at_tok_t *tok, char *buf, size_t size);
+int at_tok_ipv4(at_tok_t *tok, char *buf, size_t size);
+
+// Returns 1 if at least one more field follows
+static inline int at_tok_has_more(const at_tok_t *tok)
+{
+    return !tok->done;
+}
+
+#endif  // AT_TOK_H_
@@ -0,0 +1,10 @@
+#ifndef AT_TRIE_H_
+#define AT_TRIE_H_
+
+#include "sim7600e.h"   // AtResponseStatus_t
+#include <stddef.h>
+
+// Generated from Inc/at_status.def (see tools/gen_at_trie.py)
+AtResponseStatus_t at_trie_classify(const char *line, size_t len);
+
+#endif  // AT_TRIE_H_
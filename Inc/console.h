@@ -0,0 +1,25 @@
+#ifndef CONSOLE_H_
+#define CONSOLE_H_
+
+#include "uart.h"
+#include <stdint.h>
+#include <stddef.h>
+
+#define CONSOLE_LINE_MAX    64  // Longest command line (incl. arguments)
+#define CONSOLE_ARGS_MAX    8   // Max. number of words per command line (incl. command name)
+#define CONSOLE_TABLES_MAX  4   // Max. number of registered command tables
+
+// Command handler: argv[0] is the command name. Returns 0 on success, negative on failure.
+typedef int (*console_handler_t)(int argc, char *argv[]);
+
+typedef struct {
+    const char *name;
+    const char *help;           // One-line description for "help"
+    console_handler_t handler;
+} console_cmd_t;
+
+void console_init(uart_port_t port, const char *prompt);
+int console_register(const console_cmd_t *cmds, size_t count);
+void console_poll(void);
+
+#endif  // CONSOLE_H_
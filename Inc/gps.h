@@ -1,14 +1,18 @@
 #ifndef GPS_H_
 #define GPS_H_
 
-// #include "pack.h" ToDo: add pack.h 
+#include "pack.h"
 #include <stdint.h>
+#include <stddef.h>
 
-#define GPS_PACKET_SIZE     18
+#define GPS_PACKET_SIZE     18          // Packed record, see pack_gps()
+#define GPS_PACKET_VERSION  1
+#define GPS_COORD_SCALE     10000000L   // Coordinates are stored in 1e-7 degrees
+#define GPS_COORD_STR_LEN   13          // "-180.0000000" incl. terminator
 
 typedef struct {
-    float latitude;
-    float longitude;
+    int32_t latitude;       // 1e-7 degrees, north positive
+    int32_t longitude;      // 1e-7 degrees, east positive
     uint8_t day;
     uint8_t month;
     uint8_t year;
@@ -20,7 +24,11 @@ typedef struct {
 } gps_data_t;
 
 int parse_gps_info(const char *gps_info, gps_data_t *gps_data, uint8_t debug);
-// uint32_t pack_gps(uint8_t *buf, gps_data_t *data);
-// void unpack_gps(uint8_t *buf, gps_data_t *data);
+char *coord_to_str(char *buf, int32_t coord);
+uint32_t pack_gps(uint8_t *buf, const gps_data_t *data);
+int unpack_gps(const uint8_t *buf, gps_data_t *data);
+uint8_t gps_crc8(const uint8_t *buf, uint32_t len);
+uint32_t gps_to_seconds(const gps_data_t *data);
+void gps_from_seconds(uint32_t seconds, gps_data_t *data);
 
-#endif
\ No newline at end of file
+#endif
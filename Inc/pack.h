@@ -0,0 +1,43 @@
+#ifndef PACK_H_
+#define PACK_H_
+
+#include <stdint.h>
+
+// Big-endian (network byte order) field access for wire formats, independent of the CPU byte order
+
+static inline void pack_u16(uint8_t *buf, uint16_t value)
+{
+    buf[0] = (uint8_t)(value >> 8);
+    buf[1] = (uint8_t)value;
+}
+
+static inline void pack_u32(uint8_t *buf, uint32_t value)
+{
+    buf[0] = (uint8_t)(value >> 24);
+    buf[1] = (uint8_t)(value >> 16);
+    buf[2] = (uint8_t)(value >> 8);
+    buf[3] = (uint8_t)value;
+}
+
+// Two's complement, as uint32_t
+static inline void pack_i32(uint8_t *buf, int32_t value)
+{
+    pack_u32(buf, (uint32_t)value);
+}
+
+static inline uint16_t unpack_u16(const uint8_t *buf)
+{
+    return (uint16_t)(((uint16_t)buf[0] << 8) | buf[1]);
+}
+
+static inline uint32_t unpack_u32(const uint8_t *buf)
+{
+    return ((uint32_t)buf[0] << 24) | ((uint32_t)buf[1] << 16) | ((uint32_t)buf[2] << 8) | buf[3];
+}
+
+static inline int32_t unpack_i32(const uint8_t *buf)
+{
+    return (int32_t)unpack_u32(buf);
+}
+
+#endif  // PACK_H_
@@ -37,6 +37,7 @@ typedef enum {
     // ----------------------------------------------------------------------
     AT_HTTP_ACTION = 0x30,      // Matches "+HTTPACTION:"
     AT_INFO_CGPADDR = 0x31,     // Generic Match for CGPADDR: 
+    AT_INFO_CGACT = 0x32,       // GENERIC match for "+CGACT: " (PDP context state)
 
     // ----------------------------------------------------------------------
     // 0x40 - 0x4F: CGPS (Generic Info - Requires Detailed Parsing)
@@ -51,6 +52,8 @@ typedef enum {
     AT_URC_SMS_DONE = 0x51,     // Matches "SMS DONE" (Unsolicited)
     AT_URC_RING = 0x52,         // Matches "RING" (Unsolicited)
     AT_INFO_CSQ = 0x53,         // GENERIC match for "+CSQ: " (Signal Quality)
+    AT_URC_CGEV = 0x54,         // GENERIC match for "+CGEV: " (Packet domain event, unsolicited)
+    AT_URC_PB_DONE = 0x55,      // Matches "PB DONE" (Unsolicited, end of the boot)
     
     // ----------------------------------------------------------------------
     // 0xF0 - 0xFF: Local System/Internal Statuses
@@ -135,7 +138,64 @@ typedef enum {
     CGPADDR_STATE_INVALID = 2
 } CgpaddrState_t;
 
+typedef enum {
+    SIM7600E_EVENT_READY = 0,   // RDY: the modem has (re)started
+    SIM7600E_EVENT_SIM,         // +CPIN: SIM state changed
+    SIM7600E_EVENT_PDP,         // +CGEV: packet domain event (e.g. context deactivated by the network)
+    SIM7600E_EVENT_GPS,         // +CGPSINFO: position report outside a query
+    SIM7600E_EVENT_HTTP,        // +HTTPACTION: result outside an upload (e.g. after its timeout)
+} Sim7600eEvent_t;
+
+// Phases of the modem bring-up, see sim7600e_print_boot_report()
+typedef enum {
+    SIM7600E_PHASE_AT = 0,      // Reset and boot until AT is answered (incl. baud rate)
+    SIM7600E_PHASE_SIM,         // SIM ready (unlocked)
+    SIM7600E_PHASE_CREG,        // Registered on the network
+    SIM7600E_PHASE_CSQ,         // Signal quality checked
+    SIM7600E_PHASE_CGATT,       // Attached to the PS domain
+    SIM7600E_PHASE_PDP,         // PDP context active with an IP address
+    SIM7600E_PHASE_HTTP,        // HTTP service configured
+    SIM7600E_PHASE_GNSS,        // GPS engine on
+    SIM7600E_PHASE_COUNT
+} Sim7600eBootPhase_t;
+
+typedef struct {
+    uint32_t phase_ms[SIM7600E_PHASE_COUNT];    // Time spent in each phase (incl. retries and backoff)
+    uint16_t phase_tries[SIM7600E_PHASE_COUNT]; // Commands/actions run in each phase
+    uint32_t total_ms;
+    uint8_t complete;                           // 1: bring-up finished
+    uint8_t resumed;                            // 1: started at a previously failed step
+    uint8_t reset;                              // 1: the modem was reset (AT+CFUN=1,1), 0: warm start
+    Sim7600eBootPhase_t failed_phase;           // Valid if not complete
+} Sim7600eBootReport_t;
+
+// Completion callbacks of the background operations (called from at_engine_poll() or sim7600e_poll())
+typedef void (*sim7600e_http_cb_t)(int result, void *ctx);
+typedef void (*sim7600e_gps_cb_t)(CgpsState_t state, const char *info, void *ctx);
+// Unsolicited modem event, line is the URC without terminator (valid during the call only)
+typedef void (*sim7600e_event_cb_t)(Sim7600eEvent_t event, const char *line, size_t len, void *ctx);
+
+// Response parsers (Src/sim7600e_parse.c), response_str holds the information lines of a command
+#define IPV6_ADDR_MAX_LEN   40  // For full IPv6 address string
+
+CregState_t parse_creg_status(const char *response_str);
+CgpsState_t parse_cgps_status(const char *response_str);
+CgpsState_t parse_cgpsinfo_state(const char **response_str);
+CsqState_t parse_csq_status(const char *response_str, CsqResult_t *result);
+CgattState_t parse_cgatt_status(const char *response_str);
+CgpaddrState_t parse_cgpaddr_status(const char *response_str, char *ip_addr);
+int parse_cgact_status(const char *response_str, int cid);
+
 int sim7600e_init(const char *pin, const char *url, uint8_t debug);
-int sim7600e_get_gps_fix(char **buf, size_t len, uint32_t delay_ms, uint32_t timeout_ms, uint8_t debug);
+int sim7600e_init_start(const char *pin, const char *url, uint8_t debug);
+int sim7600e_init_busy(void);
+int sim7600e_ready(void);
+void sim7600e_poll(void);
+void sim7600e_print_boot_report(void);
+void sim7600e_set_event_callback(sim7600e_event_cb_t callback, void *ctx);
+uint32_t sim7600e_negotiate_baudrate(uint32_t max_baudrate, uint8_t debug);
+int sim7600e_http_post_async(const uint8_t *data, size_t len, uint32_t timeout_ms,
+                             sim7600e_http_cb_t callback, void *ctx, uint8_t debug);
+int sim7600e_gps_poll_async(sim7600e_gps_cb_t callback, void *ctx, uint8_t debug);
 
 #endif  // SIM7600E_H_
\ No newline at end of file
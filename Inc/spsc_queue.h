@@ -0,0 +1,58 @@
+#ifndef SPSC_QUEUE_H_
+#define SPSC_QUEUE_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+  Lock-free single-producer/single-consumer byte queue.
+
+  One context (e.g. an ISR or a DMA completion handler) may produce while another
+  one (e.g. the main loop) consumes, without disabling interrupts. The producer only
+  writes `head`, the consumer only writes `tail`. Both are free-running counters, so
+  the whole buffer can be used and (head - tail) is always the fill level.
+
+  The buffer size must be a power of two; indexing is done with a mask.
+  Besides single-byte and bulk copies, the queue hands out contiguous spans of its
+  own storage (peek/commit) for zero-copy producers and consumers such as DMA.
+*/
+typedef struct {
+    uint8_t *buf;
+    uint32_t size;
+    uint32_t mask;
+    volatile uint32_t head;     // Total bytes produced (producer only)
+    volatile uint32_t tail;     // Total bytes consumed (consumer only)
+} spsc_queue_t;
+
+int spsc_queue_init(spsc_queue_t *q, uint8_t *buf, uint32_t size);
+
+/**
+  * @brief  Number of bytes ready to be consumed.
+  */
+static inline uint32_t spsc_queue_count(const spsc_queue_t *q)
+{
+    return q->head - q->tail;
+}
+
+/**
+  * @brief  Number of bytes that can be produced without overwriting unread data.
+  */
+static inline uint32_t spsc_queue_space(const spsc_queue_t *q)
+{
+    return q->size - (q->head - q->tail);
+}
+
+// Producer side
+int spsc_queue_push(spsc_queue_t *q, uint8_t byte);
+uint32_t spsc_queue_push_n(spsc_queue_t *q, const uint8_t *data, uint32_t len);
+uint32_t spsc_queue_peek_write(spsc_queue_t *q, uint8_t **span);
+void spsc_queue_commit_write(spsc_queue_t *q, uint32_t len);
+
+// Consumer side
+int spsc_queue_pop(spsc_queue_t *q, uint8_t *byte);
+uint32_t spsc_queue_pop_n(spsc_queue_t *q, uint8_t *data, uint32_t len);
+uint32_t spsc_queue_peek_read(spsc_queue_t *q, const uint8_t **span);
+void spsc_queue_commit_read(spsc_queue_t *q, uint32_t len);
+void spsc_queue_discard(spsc_queue_t *q);
+
+#endif  // SPSC_QUEUE_H_
@@ -0,0 +1,47 @@
+#ifndef TRACK_BUFFER_H_
+#define TRACK_BUFFER_H_
+
+#include "gps.h"
+#include <stdint.h>
+
+typedef enum {
+    TRACK_OVERWRITE_OLDEST = 0,     // A new point replaces the oldest one when full
+    TRACK_STOP_WHEN_FULL,           // New points are rejected when full
+} track_policy_t;
+
+/*
+  Fixed-capacity ring of track points in caller-provided storage.
+
+  Every appended point gets a sequence number (points ever appended). The uploader
+  reads points by index without removing them and releases them by sequence number
+  once the upload has succeeded, so points overwritten meanwhile are not released twice.
+*/
+typedef struct {
+    gps_data_t *points;
+    uint16_t capacity;
+    uint16_t head;                  // Index of the oldest point
+    uint16_t count;
+    track_policy_t policy;
+    uint32_t oldest_seq;            // Sequence number of the oldest point
+    uint32_t overwritten;           // Points lost to TRACK_OVERWRITE_OLDEST
+    uint32_t rejected;              // Points refused by TRACK_STOP_WHEN_FULL
+} track_buffer_t;
+
+void track_buffer_init(track_buffer_t *tb, gps_data_t *storage, uint16_t capacity, track_policy_t policy);
+int track_buffer_push(track_buffer_t *tb, const gps_data_t *point);
+const gps_data_t *track_buffer_peek(const track_buffer_t *tb, uint16_t index);
+void track_buffer_release(track_buffer_t *tb, uint32_t end_seq);
+
+// Number of stored points
+static inline uint16_t track_buffer_count(const track_buffer_t *tb)
+{
+    return tb->count;
+}
+
+// Sequence number of the oldest stored point (index 0 of track_buffer_peek())
+static inline uint32_t track_buffer_oldest(const track_buffer_t *tb)
+{
+    return tb->oldest_seq;
+}
+
+#endif  // TRACK_BUFFER_H_
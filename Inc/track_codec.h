@@ -0,0 +1,34 @@
+#ifndef TRACK_CODEC_H_
+#define TRACK_CODEC_H_
+
+#include "gps.h"
+#include <stdint.h>
+
+// Batch of track points (big-endian where fixed width):
+// version(1) count(1) first point as packed GPS record(GPS_PACKET_SIZE)
+// then per further point the zigzag varint deltas of latitude, longitude, seconds, altitude, speed,
+// and a CRC-8 over all preceding bytes.
+#define TRACK_BATCH_VERSION     2       // Differs from GPS_PACKET_VERSION: the first byte tells both apart
+#define TRACK_BATCH_HEADER_LEN  2
+#define TRACK_BATCH_MIN_LEN     (TRACK_BATCH_HEADER_LEN + GPS_PACKET_SIZE + 1)
+#define TRACK_BATCH_POINTS_MAX  255
+#define TRACK_DELTA_MAX_LEN     25      // Five varints of up to 5 bytes each
+
+typedef struct {
+    uint8_t *buf;
+    uint32_t size;
+    uint32_t len;                       // Bytes used (without the CRC)
+    uint8_t count;
+    gps_data_t last;                    // Previous point, base of the next delta
+    uint32_t last_seconds;
+} track_encoder_t;
+
+// Receives one decoded point
+typedef void (*track_point_cb_t)(const gps_data_t *point, void *ctx);
+
+void track_encoder_init(track_encoder_t *enc, uint8_t *buf, uint32_t size);
+int track_encoder_add(track_encoder_t *enc, const gps_data_t *point);
+uint32_t track_encoder_finish(track_encoder_t *enc);
+int32_t track_decode(const uint8_t *buf, uint32_t len, track_point_cb_t callback, void *ctx);
+
+#endif  // TRACK_CODEC_H_
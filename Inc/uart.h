@@ -2,18 +2,92 @@
 #define UART_H_
 
 #include "stm32f4xx.h"
+#include <stdint.h>
 #include <stddef.h> // For size_t
 
-// UART1 is used for communication with SIM7600E-Module
-int uart1_init(void);
-int uart1_write_nb(int ch);
-int uart1_read_nb(void);
-void uart1_flush_rx_buffer(void);
+// UART instances of the STM32F407 (index into the driver's descriptor table)
+typedef enum {
+    UART_PORT_1 = 0,    // USART1: PB6/PB7,   RTS/CTS PA12/PA11, APB2
+    UART_PORT_2,        // USART2: PA2/PA3,   RTS/CTS PA1/PA0,   APB1
+    UART_PORT_3,        // USART3: PB10/PB11, RTS/CTS PB14/PB13, APB1
+    UART_PORT_4,        // UART4:  PC10/PC11, no flow control,   APB1
+    UART_PORT_5,        // UART5:  PC12/PD2,  no flow control,   APB1
+    UART_PORT_6,        // USART6: PC6/PC7,   no flow control,   APB2
+    UART_PORT_COUNT
+} uart_port_t;
 
-// UART2 is used to print the Debug-Mesages on the Host-PC 
-int uart2_init(void);
-int uart2_write(int ch);
-int uart2_read(void);
+// Port assignment on the tracker board
+#define MODEM_UART      UART_PORT_1     // UART1 is used for communication with SIM7600E-Module
+#define DBG_UART        UART_PORT_2     // UART2 is used to print the Debug-Mesages on the Host-PC
 
+// Limit of uart_flush_tx() in uart_set_baudrate() and _exit(): drains a full 1 KB ring at 9600 baud
+#define UART_FLUSH_TIMEOUT_MS   1500
 
-#endif  // UART_H_
\ No newline at end of file
+// Behaviour of the buffered TX path when its ring buffer is full
+typedef enum {
+    UART_TX_POLICY_DROP = 0,    // Return early with the bytes that fit (counted), the caller keeps the rest
+    UART_TX_POLICY_BLOCK = 1,   // Wait until the DMA has freed enough space (counted)
+} uart_tx_policy_t;
+
+// Per-port configuration passed to uart_init().
+// The ring buffers are owned by the caller; their sizes must be powers of two (max. 32768).
+typedef struct {
+    uint32_t baudrate;
+    uint8_t *rx_buf;
+    uint16_t rx_buf_size;
+    uint8_t *tx_buf;
+    uint16_t tx_buf_size;
+    uint8_t rx_dma;             // 1: circular DMA reception, 0: RXNE interrupt
+    uint8_t tx_dma;             // 1: DMA transmission, 0: TXE interrupt
+    uint8_t flow_control;       // 1: RTS/CTS (only on ports with flow control pins)
+    uint8_t irq_priority;       // NVIC priority of the USART and DMA interrupts (0 = highest)
+    uart_tx_policy_t tx_policy;
+} uart_config_t;
+
+// Per-port instrumentation counters (cumulative since uart_init() or uart_reset_stats())
+typedef struct {
+    uint32_t rx_bytes;          // Bytes received into the RX ring buffer
+    uint32_t tx_bytes;          // Bytes handed to the USART
+    uint32_t rx_dropped;        // Bytes lost because the RX ring buffer was full / overwritten
+    uint32_t rx_overrun;        // RX DMA caught up with the reader and overwrote unread bytes
+    uint32_t overrun_errors;    // ORE: a byte arrived before the previous one was read
+    uint32_t framing_errors;    // FE: missing stop bit (baudrate mismatch, break, noise)
+    uint32_t noise_errors;      // NE: noise detected during sampling
+    uint32_t parity_errors;     // PE
+    uint32_t rx_high_water;     // Highest RX ring buffer fill level seen (bytes)
+    uint32_t tx_high_water;     // Highest TX ring buffer fill level seen (bytes)
+    uint32_t rx_dma_half;       // RX DMA half-transfer events (circular mode)
+    uint32_t rx_dma_full;       // RX DMA transfer-complete events = ring buffer wrap-arounds
+    uint32_t tx_dma_blocks;     // Completed TX DMA transfers
+} uart_stats_t;
+
+int uart_init(uart_port_t port, const uart_config_t *config);
+
+// Baudrate and flow control
+int uart_baudrate_supported(uart_port_t port, uint32_t baudrate);
+int uart_set_baudrate(uart_port_t port, uint32_t baudrate);
+int uart_set_flow_control(uart_port_t port, uint8_t enable);
+
+// Reception (non-blocking, served from the RX ring buffer)
+int uart_read_nb(uart_port_t port);
+size_t uart_rx_available(uart_port_t port);
+size_t uart_rx_peek(uart_port_t port, const uint8_t **span);
+void uart_rx_consume(uart_port_t port, size_t len);
+uint32_t uart_rx_idle_count(uart_port_t port);
+void uart_flush_rx(uart_port_t port);
+
+// Transmission (queued in the TX ring buffer)
+int uart_write_nb(uart_port_t port, int ch);
+size_t uart_write(uart_port_t port, const uint8_t *data, size_t len);
+void uart_set_tx_policy(uart_port_t port, uart_tx_policy_t policy);
+uint32_t uart_tx_dropped(uart_port_t port);
+uint32_t uart_tx_blocked(uart_port_t port);
+int uart_flush_tx(uart_port_t port, uint32_t timeout_ms);
+
+// Instrumentation
+int uart_get_stats(uart_port_t port, uart_stats_t *stats);
+void uart_reset_stats(uart_port_t port);
+void uart_print_stats(uart_port_t port);
+
+
+#endif  // UART_H_
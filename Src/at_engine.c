@@ -0,0 +1,561 @@
+#include "at_engine.h"
+#include "at_framer.h"
+#include "systick.h"
+
+#include <stdio.h>
+
+
+typedef struct {
+    const char *prefix;
+    size_t prefix_len;
+    at_urc_handler_t handler;
+    void *ctx;
+} at_urc_entry_t;
+
+static struct {
+    uart_port_t port;
+    at_classify_t classify;
+    at_framer_t framer;
+    at_cmd_t *queue[AT_ENGINE_QUEUE_LEN];   // FIFO of submitted commands
+    uint8_t queue_head;
+    uint8_t queue_count;
+    at_cmd_t *active;                       // Command being transmitted or answered
+    size_t tx_part;                         // Transmission progress of the active command
+    size_t tx_offset;
+    at_urc_entry_t urcs[AT_URC_HANDLERS_MAX];
+    size_t urc_count;
+    uint32_t rx_idle;                       // uart_rx_idle_count() at the last run of the framer
+    uint8_t initialized;
+} engine;
+
+// Latency histograms per command type, filled in order of first use
+static at_stats_t at_stats[AT_STATS_TYPES_MAX];
+static size_t at_stats_count;
+static uint32_t at_stats_untracked;     // Commands of types beyond AT_STATS_TYPES_MAX
+
+// Ring buffer with the most recent AT traffic, oldest bytes are overwritten
+static char at_transcript[AT_TRANSCRIPT_SIZE];
+static uint32_t at_transcript_total;    // Bytes ever written (write position = total % size)
+
+// Append raw bytes to the AT transcript
+static void at_transcript_put(const char *data, size_t len)
+{
+    for (size_t i = 0; i < len; i++) {
+        at_transcript[at_transcript_total % AT_TRANSCRIPT_SIZE] = data[i];
+        at_transcript_total++;
+    }
+}
+
+// Statistics key of a command: the command name ("AT+CREG?" -> "+CREG")
+static void at_stats_name(const at_cmd_t *cmd, char *name)
+{
+    const char *src = "AT";
+    size_t len = 2;
+
+    if (cmd->raw) {
+        src = "(data)";
+        len = 6;
+    } else if (cmd->count == 0) {
+        src = "(wait)";
+        len = 6;
+    } else if (cmd->parts[0].len > 2) {
+        src = &cmd->parts[0].base[2];
+        len = 0;
+        while (len < cmd->parts[0].len - 2 && src[len] != '=' && src[len] != '?' && src[len] != '\r') {
+            len++;
+        }
+        if (len == 0) {
+            src = "AT";
+            len = 2;
+        }
+    }
+
+    if (len > AT_STATS_NAME_LEN - 1) {
+        len = AT_STATS_NAME_LEN - 1;
+    }
+    memcpy(name, src, len);
+    name[len] = '\0';
+}
+
+// Histogram bucket of a latency: 0 for < 1 ms, else 1 + floor(log2(ms)), capped at the last bucket
+static uint8_t at_stats_bucket(uint32_t ms)
+{
+    uint8_t bucket = 0;
+
+    while (ms > 0 && bucket < AT_STATS_BUCKETS - 1) {
+        ms >>= 1;
+        bucket++;
+    }
+    return bucket;
+}
+
+// Record the latency and outcome of a finished command
+static void at_stats_record(const at_cmd_t *cmd, AtResponseStatus_t final)
+{
+    char name[AT_STATS_NAME_LEN];
+    uint32_t elapsed = system_get_tick_ms() - cmd->start_ms;
+    at_stats_t *stats = NULL;
+
+    at_stats_name(cmd, name);
+    for (size_t i = 0; i < at_stats_count; i++) {
+        if (strcmp(at_stats[i].name, name) == 0) {
+            stats = &at_stats[i];
+            break;
+        }
+    }
+    if (stats == NULL) {
+        if (at_stats_count >= AT_STATS_TYPES_MAX) {
+            at_stats_untracked++;
+            return;
+        }
+        stats = &at_stats[at_stats_count++];
+        memset(stats, 0, sizeof(*stats));
+        memcpy(stats->name, name, sizeof(stats->name));
+    }
+
+    stats->buckets[at_stats_bucket(elapsed)]++;
+    if (elapsed > stats->max_ms) {
+        stats->max_ms = elapsed;
+    }
+    stats->timeout_ms = cmd->timeout_ms;
+
+    if (final == AT_TIMEOUT || final == AT_TX_FAILURE) {
+        stats->timeout++;
+    } else if (final == AT_ERROR || final == AT_CME_ERROR || final == AT_CMS_ERROR || final == AT_NO_CARRIER) {
+        stats->error++;
+    } else {
+        stats->ok++;
+    }
+}
+
+// Check for the command echo (ATE1), which repeats the command line
+static inline int at_is_echo(const char *line, size_t len)
+{
+    return (len >= 2) && (line[0] == 'A' || line[0] == 'a') && (line[1] == 'T' || line[1] == 't');
+}
+
+// Append an information line to the response (counted as dropped if it does not fit)
+static void at_resp_add(at_resp_t *resp, const char *line, size_t len, AtResponseStatus_t status)
+{
+    if (resp->count >= AT_RESP_LINES_MAX || len + 1 > (size_t)(AT_RESP_ARENA_SIZE - resp->used)) {
+        resp->dropped++;
+        return;
+    }
+
+    char *text = &resp->arena[resp->used];
+    memcpy(text, line, len);
+    text[len] = '\0';
+    resp->used += (uint16_t)(len + 1);
+
+    resp->lines[resp->count].text = text;
+    resp->lines[resp->count].len = (uint16_t)len;
+    resp->lines[resp->count].status = status;
+    resp->count++;
+}
+
+// Returns the first information line of the given status, or NULL
+const char *at_resp_find(const at_resp_t *resp, AtResponseStatus_t status)
+{
+    if (resp == NULL) {
+        return NULL;
+    }
+
+    for (uint8_t i = 0; i < resp->count; i++) {
+        if (resp->lines[i].status == status) {
+            return resp->lines[i].text;
+        }
+    }
+    return NULL;
+}
+
+// Initialize the engine for the modem on the given port. classify maps a line to its status.
+void at_engine_init(uart_port_t port, at_classify_t classify)
+{
+    engine.port = port;
+    engine.classify = classify;
+    engine.queue_head = 0;
+    engine.queue_count = 0;
+    engine.active = NULL;
+    engine.urc_count = 0;
+    at_framer_init(&engine.framer, port);
+    engine.rx_idle = uart_rx_idle_count(port) - 1;     // Frame what has arrived so far at the first poll
+    engine.initialized = 1;
+}
+
+// Register a handler for unsolicited lines starting with prefix (e.g. "+CGEV: "). The prefix
+// must stay valid (e.g. a string literal). Several handlers may match the same line.
+// Returns 0 on success, -1 if the table is full or the parameters are invalid.
+int at_engine_register_urc(const char *prefix, at_urc_handler_t handler, void *ctx)
+{
+    if (!engine.initialized || prefix == NULL || handler == NULL || engine.urc_count >= AT_URC_HANDLERS_MAX) {
+        return -1;
+    }
+
+    engine.urcs[engine.urc_count].prefix = prefix;
+    engine.urcs[engine.urc_count].prefix_len = strlen(prefix);
+    engine.urcs[engine.urc_count].handler = handler;
+    engine.urcs[engine.urc_count].ctx = ctx;
+    engine.urc_count++;
+
+    return 0;
+}
+
+// Queue a command. Returns 0 on success, -1 if the queue is full, the command is
+// still pending or its parameters are invalid. The result is reported by the callback
+// and in cmd->state / cmd->status.
+int at_engine_submit(at_cmd_t *cmd)
+{
+    // Input parameter check
+    if (!engine.initialized || cmd == NULL) {
+        return -1;
+    }
+
+    if (cmd->parts == NULL && cmd->count != 0) {
+        return -1;
+    }
+
+    if (cmd->state == AT_CMD_PENDING || engine.queue_count >= AT_ENGINE_QUEUE_LEN) {
+        return -1;
+    }
+
+    cmd->state = AT_CMD_PENDING;
+    cmd->status = AT_RX_PARTIAL;
+    engine.queue[(engine.queue_head + engine.queue_count) % AT_ENGINE_QUEUE_LEN] = cmd;
+    engine.queue_count++;
+
+    return 0;
+}
+
+// Finish the active command and report the result. final is the final result code,
+// status the result reported in cmd->status.
+static void at_engine_complete(AtResponseStatus_t final, AtResponseStatus_t status)
+{
+    at_cmd_t *cmd = engine.active;
+
+    // Release the engine first, so the callback can submit the next command
+    engine.active = NULL;
+    cmd->status = status;
+    cmd->state = AT_CMD_DONE;
+    if (cmd->resp != NULL) {
+        cmd->resp->final = final;
+    }
+    at_stats_record(cmd, final);
+
+    if (cmd->callback != NULL) {
+        cmd->callback(cmd, cmd->ctx);
+    }
+}
+
+// Take the next command from the queue and start its transmission
+static void at_engine_start_next(void)
+{
+    at_cmd_t *cmd = engine.queue[engine.queue_head];
+
+    engine.queue_head = (engine.queue_head + 1) % AT_ENGINE_QUEUE_LEN;
+    engine.queue_count--;
+
+    engine.active = cmd;
+    engine.tx_part = 0;
+    engine.tx_offset = 0;
+    cmd->start_ms = system_get_tick_ms();
+    cmd->info = AT_RX_PARTIAL;
+    if (cmd->resp != NULL) {
+        cmd->resp->used = 0;
+        cmd->resp->count = 0;
+        cmd->resp->dropped = 0;
+        cmd->resp->final = AT_RX_PARTIAL;
+    }
+
+    if (cmd->count == 0 || cmd->raw) {
+        return;     // Wait-only request, or payload data
+    }
+
+    // Print AT-Command (should already include '\r') and record it without the '\r'
+    at_transcript_put(">>> ", 4);
+    if (cmd->debug) printf(">>> ");
+    for (size_t i = 0; i < cmd->count; i++) {
+        size_t n = cmd->parts[i].len;
+
+        if (cmd->debug) printf("%.*s", (int)n, cmd->parts[i].base);
+        if (i == cmd->count - 1 && n > 0 && cmd->parts[i].base[n - 1] == '\r') {
+            n--;
+        }
+        at_transcript_put(cmd->parts[i].base, n);
+    }
+    at_transcript_put("\r\n", 2);
+    if (cmd->debug) printf("\r\n");
+}
+
+// Queue as much of the active command as the UART TX ring buffer takes right now
+static void at_engine_transmit(at_cmd_t *cmd)
+{
+    while (engine.tx_part < cmd->count) {
+        const at_iovec_t *part = &cmd->parts[engine.tx_part];
+        size_t remaining = part->len - engine.tx_offset;
+
+        if (remaining > 0) {
+            size_t n = uart_write(engine.port, (const uint8_t *)&part->base[engine.tx_offset], remaining);
+            engine.tx_offset += n;
+            if (n < remaining) {
+                return;     // TX ring buffer full, continue with the next poll
+            }
+        }
+
+        engine.tx_part++;
+        engine.tx_offset = 0;
+    }
+}
+
+// Pass an unsolicited line to all matching handlers
+static void at_engine_dispatch_urc(const char *line, size_t len)
+{
+    for (size_t i = 0; i < engine.urc_count; i++) {
+        const at_urc_entry_t *urc = &engine.urcs[i];
+
+        if (len >= urc->prefix_len && strncmp(line, urc->prefix, urc->prefix_len) == 0) {
+            urc->handler(line, len, urc->ctx);
+        }
+    }
+}
+
+// Decide whether a line answers the active command (all others are unsolicited).
+// Information lines of extended commands repeat the command name ("+CREG: ..." after
+// AT+CREG?), so other lines starting with '+' and the known URCs belong to nobody.
+static int at_engine_owns(const at_cmd_t *cmd, const char *line, size_t len, AtResponseStatus_t status)
+{
+    if (cmd->wait_for != AT_RX_PARTIAL) {
+        return status == cmd->wait_for;
+    }
+
+    if (status == AT_URC_RDY || status == AT_URC_SMS_DONE || status == AT_URC_PB_DONE || status == AT_URC_RING) {
+        return 0;
+    }
+
+    // Final result codes (incl. +CME ERROR) and plain text responses
+    if (status <= AT_DOWNLOAD_READY || line[0] != '+') {
+        return 1;
+    }
+
+    if (cmd->count == 0 || cmd->raw) {
+        return 0;
+    }
+
+    // Compare "+NAME" with the command "AT+NAME", "AT+NAME=...", "AT+NAME?"
+    const at_iovec_t *first = &cmd->parts[0];
+    size_t n = 0;
+    while (n < len && line[n] != ':') {
+        n++;
+    }
+
+    if (first->len < n + 2 || strncmp(&first->base[2], line, n) != 0) {
+        return 0;
+    }
+
+    // The name must end there too: "+CGPS" does not answer AT+CGPSINFO
+    if (first->len == n + 2) {
+        return 1;
+    }
+    char next = first->base[n + 2];
+    return (next == '=') || (next == '?') || (next == '\r');
+}
+
+// Handle one received line: part of the active command's response, or unsolicited
+static void at_engine_line(const char *line, size_t len)
+{
+    if (at_is_echo(line, len)) {
+        return;
+    }
+
+    at_transcript_put("<<< ", 4);
+    at_transcript_put(line, len);
+    at_transcript_put("\r\n", 2);
+
+    AtResponseStatus_t status = engine.classify(line, len);
+    at_cmd_t *cmd = engine.active;
+
+    // Lines before the command has been sent completely cannot be its response
+    if (cmd == NULL || engine.tx_part < cmd->count || !at_engine_owns(cmd, line, len, status)) {
+        at_engine_dispatch_urc(line, len);
+        return;
+    }
+
+    if (cmd->debug) printf("<<< %.*s\r\n", (int)len, line);
+
+    // Waiting for a specific line (e.g. a URC following the final result code)
+    if (cmd->wait_for != AT_RX_PARTIAL) {
+        if (cmd->resp != NULL) {
+            at_resp_add(cmd->resp, line, len, status);
+        }
+        at_engine_complete(status, status);
+        return;
+    }
+
+    // Final result code: the command is complete. On success report the information line, if any.
+    if (status <= AT_DOWNLOAD_READY) {
+        at_engine_complete(status, (status == AT_OK && cmd->info != AT_RX_PARTIAL) ? cmd->info : status);
+        return;
+    }
+
+    if (cmd->info == AT_RX_PARTIAL) {
+        cmd->info = status;
+    }
+    if (cmd->resp != NULL) {
+        at_resp_add(cmd->resp, line, len, status);
+    }
+}
+
+// Start the next queued command if the engine is idle, and continue the active command's transmission
+static void at_engine_kick(void)
+{
+    if (engine.active == NULL && engine.queue_count > 0) {
+        at_engine_start_next();
+    }
+
+    if (engine.active != NULL) {
+        at_engine_transmit(engine.active);
+    }
+}
+
+// Run the engine: start queued commands, transmit, dispatch received lines, check timeouts.
+// Never blocks; call it from the main loop.
+void at_engine_poll(void)
+{
+    const char *line;
+    size_t len;
+
+    if (!engine.initialized) {
+        return;
+    }
+
+    at_engine_kick();
+
+    // The modem sends its lines in bursts, so the framer only runs after the end of one (IDLE
+    // line) or once a line's worth of data is waiting; in between it would find incomplete lines
+    uint32_t idle = uart_rx_idle_count(engine.port);
+
+    if (idle != engine.rx_idle || uart_rx_available(engine.port) >= AT_FRAMER_LINE_MAX) {
+        engine.rx_idle = idle;
+
+        // A line completing the active command starts the next one before the following lines are
+        // dispatched, so they are matched against that command instead of being taken for URCs
+        while (at_framer_next(&engine.framer, &line, &len)) {
+            at_engine_line(line, len);
+            at_engine_kick();
+        }
+    }
+
+    at_cmd_t *cmd = engine.active;
+    if (cmd != NULL && (system_get_tick_ms() - cmd->start_ms) >= cmd->timeout_ms) {
+        if (engine.tx_part < cmd->count) {
+            if (cmd->debug) printf("Error: UART write timed out during TX.\r\n");
+            at_engine_complete(AT_TX_FAILURE, AT_TX_FAILURE);
+        } else {
+            if (cmd->debug) printf("Error: No response or read timeout.\r\n");
+            at_engine_complete(AT_TIMEOUT, AT_TIMEOUT);
+        }
+    }
+}
+
+// Blocking helper: submit the command and run the engine until it is done.
+// Must not be called from a completion callback.
+AtResponseStatus_t at_engine_execute(at_cmd_t *cmd)
+{
+    if (at_engine_submit(cmd) != 0) {
+        return AT_INVALID_PARAM;
+    }
+
+    while (cmd->state != AT_CMD_DONE) {
+        at_engine_poll();
+    }
+
+    return cmd->status;
+}
+
+// Returns 1 while a command is running or queued
+int at_engine_busy(void)
+{
+    return (engine.active != NULL) || (engine.queue_count > 0);
+}
+
+// Discard all received data, including a partially received line
+void at_engine_flush_rx(void)
+{
+    at_framer_flush(&engine.framer);
+}
+
+// Print the most recent AT commands and responses (oldest first)
+void at_engine_print_transcript(void)
+{
+    uint32_t total = at_transcript_total;
+    uint32_t count = (total < AT_TRANSCRIPT_SIZE) ? total : AT_TRANSCRIPT_SIZE;
+    uint32_t pos = total - count;
+
+    // After a wrap-around the oldest line is incomplete: start with the next one
+    if (total > AT_TRANSCRIPT_SIZE) {
+        while (pos < total && at_transcript[pos % AT_TRANSCRIPT_SIZE] != '\n') {
+            pos++;
+        }
+        pos++;
+    }
+
+    for (; pos < total; pos++) {
+        putchar(at_transcript[pos % AT_TRANSCRIPT_SIZE]);
+    }
+    printf("--- %lu bytes of AT traffic in total ---\r\n", total);
+}
+
+// Clear all latency histograms
+void at_engine_reset_stats(void)
+{
+    at_stats_count = 0;
+    at_stats_untracked = 0;
+}
+
+// Upper bound (ms) of the bucket containing the given percentile
+static uint32_t at_stats_percentile(const at_stats_t *stats, uint32_t total, uint32_t percent)
+{
+    uint32_t target = (total * percent + 99) / 100;
+    uint32_t sum = 0;
+
+    for (uint8_t i = 0; i < AT_STATS_BUCKETS; i++) {
+        sum += stats->buckets[i];
+        if (sum >= target) {
+            return (i < AT_STATS_BUCKETS - 1) ? (1UL << i) : stats->max_ms;
+        }
+    }
+    return stats->max_ms;
+}
+
+// Print the latency histograms (TX start to final result) and outcomes per command type
+void at_engine_print_stats(void)
+{
+    printf("%-15s %6s %6s %6s %6s %8s %8s %8s %8s\r\n",
+           "Command", "Count", "OK", "Error", "T/O", "p50<ms", "p90<ms", "Max ms", "T/O ms");
+
+    for (size_t i = 0; i < at_stats_count; i++) {
+        const at_stats_t *stats = &at_stats[i];
+        uint32_t total = stats->ok + stats->error + stats->timeout;
+
+        printf("%-15s %6lu %6lu %6lu %6lu %8lu %8lu %8lu %8lu\r\n", stats->name, total,
+               stats->ok, stats->error, stats->timeout, at_stats_percentile(stats, total, 50),
+               at_stats_percentile(stats, total, 90), stats->max_ms, stats->timeout_ms);
+
+        // Non-empty buckets as "<upper bound>:count"
+        printf("   ");
+        for (uint8_t b = 0; b < AT_STATS_BUCKETS; b++) {
+            if (stats->buckets[b] == 0) {
+                continue;
+            }
+            if (b < AT_STATS_BUCKETS - 1) {
+                printf(" <%lu:%lu", 1UL << b, stats->buckets[b]);
+            } else {
+                printf(" >=%lu:%lu", 1UL << (b - 1), stats->buckets[b]);
+            }
+        }
+        printf("\r\n");
+    }
+
+    if (at_stats_untracked > 0) {
+        printf("%lu commands of further types not tracked.\r\n", at_stats_untracked);
+    }
+}
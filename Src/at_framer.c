@@ -0,0 +1,116 @@
+#include "at_framer.h"
+
+#include <string.h>
+
+
+// Initialize an empty framer reading from the given UART port
+void at_framer_init(at_framer_t *framer, uart_port_t port)
+{
+    framer->port = port;
+    framer->len = 0;
+    framer->pending = 0;
+    framer->truncated = 0;
+}
+
+// Length of a line without its trailing CRs (the echo ends with "\r\r\n")
+static size_t at_line_trim(const char *line, size_t len)
+{
+    while (len > 0 && line[len - 1] == '\r') {
+        len--;
+    }
+    return len;
+}
+
+// Append a fragment to the scratch buffer, dropping what does not fit
+static void at_framer_collect(at_framer_t *framer, const uint8_t *data, size_t len)
+{
+    size_t space = AT_FRAMER_LINE_MAX - framer->len;
+
+    if (len > space) {
+        len = space;
+        framer->truncated = 1;
+    }
+
+    memcpy(&framer->line[framer->len], data, len);
+    framer->len += len;
+}
+
+// Get the next complete line. Returns 1 and sets line/len if one is available, 0 otherwise.
+// The slice stays valid until the next call of at_framer_next() or at_framer_flush().
+int at_framer_next(at_framer_t *framer, const char **line, size_t *len)
+{
+    // Input parameter check
+    if (framer == NULL || line == NULL || len == NULL) {
+        return 0;
+    }
+
+    // Release the slice handed out by the previous call
+    if (framer->pending != 0) {
+        uart_rx_consume(framer->port, framer->pending);
+        framer->pending = 0;
+    }
+
+    while (1) {
+        const uint8_t *span;
+        size_t span_len = uart_rx_peek(framer->port, &span);
+
+        if (span_len == 0) {
+            return 0;   // No data
+        }
+
+        const uint8_t *lf = memchr(span, '\n', span_len);
+
+        if (lf == NULL) {
+            // Incomplete line: leave it in place, unless it wraps around the end of the
+            // ring buffer (more data behind the span) or is already too long for a line
+            if (uart_rx_available(framer->port) <= span_len && span_len < AT_FRAMER_LINE_MAX) {
+                return 0;
+            }
+            at_framer_collect(framer, span, span_len);
+            uart_rx_consume(framer->port, span_len);
+            continue;
+        }
+
+        size_t content_len = (size_t)(lf - span);
+
+        if (framer->len == 0 && !framer->truncated) {
+            // The whole line is contiguous: hand it out in place
+            size_t trimmed = at_line_trim((const char *)span, content_len);
+
+            if (trimmed == 0) {
+                uart_rx_consume(framer->port, content_len + 1);     // Empty line
+                continue;
+            }
+
+            framer->pending = content_len + 1;
+            *line = (const char *)span;
+            *len = trimmed;
+            return 1;
+        }
+
+        // Rest of a wrapped line: complete it in the scratch buffer
+        at_framer_collect(framer, span, content_len);
+        uart_rx_consume(framer->port, content_len + 1);
+
+        size_t trimmed = at_line_trim(framer->line, framer->len);
+        framer->len = 0;
+        framer->truncated = 0;
+
+        if (trimmed == 0) {
+            continue;   // Empty line
+        }
+
+        *line = framer->line;
+        *len = trimmed;
+        return 1;
+    }
+}
+
+// Discard all buffered data, including a partially assembled line
+void at_framer_flush(at_framer_t *framer)
+{
+    framer->pending = 0;
+    framer->len = 0;
+    framer->truncated = 0;
+    uart_flush_rx(framer->port);
+}
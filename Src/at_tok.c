@@ -0,0 +1,198 @@
+#include "at_tok.h"
+
+#include <string.h>
+#include <limits.h>
+
+
+static inline int at_tok_is_eol(char ch)
+{
+    return ch == '\0' || ch == '\r' || ch == '\n';
+}
+
+// Find the first line of the response starting with prefix (e.g. "+CSQ: ") and set the cursor
+// to its first field. For the next matching line call it again with tok->end as response.
+// Returns 0 on success, -1 if no line matches.
+int at_tok_start(at_tok_t *tok, const char *response, const char *prefix)
+{
+    // Check input parameters
+    if (tok == NULL || response == NULL || prefix == NULL) {
+        return -1;
+    }
+
+    size_t prefix_len = strlen(prefix);
+    const char *line = response;
+
+    while (*line != '\0') {
+        // Skip the terminator of the previous line
+        while (*line == '\r' || *line == '\n') {
+            line++;
+        }
+
+        const char *end = line;
+        while (!at_tok_is_eol(*end)) {
+            end++;
+        }
+
+        if ((size_t)(end - line) >= prefix_len && strncmp(line, prefix, prefix_len) == 0) {
+            tok->pos = line + prefix_len;
+            tok->end = end;
+            tok->done = 0;
+            return 0;
+        }
+        line = end;
+    }
+
+    return -1;
+}
+
+// Take the next field (commas inside double quotes do not split). An empty field has len 0.
+// Returns 0 on success, -1 if all fields are consumed.
+int at_tok_next(at_tok_t *tok, const char **field, size_t *len)
+{
+    const char *p = tok->pos;
+    uint8_t quoted = 0;
+
+    if (tok->done) {
+        return -1;
+    }
+
+    while (p < tok->end && (quoted || *p != ',')) {
+        if (*p == '"') {
+            quoted = !quoted;
+        }
+        p++;
+    }
+
+    *field = tok->pos;
+    *len = (size_t)(p - tok->pos);
+
+    if (p < tok->end) {
+        tok->pos = p + 1;   // Skip the comma
+    } else {
+        tok->pos = p;
+        tok->done = 1;
+    }
+    return 0;
+}
+
+// Take the next field without surrounding spaces and double quotes
+static int at_tok_next_trimmed(at_tok_t *tok, const char **field, size_t *len)
+{
+    const char *f;
+    size_t n;
+
+    if (at_tok_next(tok, &f, &n) != 0) {
+        return -1;
+    }
+
+    while (n > 0 && *f == ' ') {
+        f++;
+        n--;
+    }
+    while (n > 0 && f[n - 1] == ' ') {
+        n--;
+    }
+    if (n >= 2 && f[0] == '"' && f[n - 1] == '"') {
+        f++;
+        n -= 2;
+    }
+
+    *field = f;
+    *len = n;
+    return 0;
+}
+
+// Take the next field as a decimal integer with optional sign.
+// Returns 0 on success, -1 if the field is missing, empty, not a number or out of range.
+int at_tok_int(at_tok_t *tok, int *value)
+{
+    const char *f;
+    size_t n;
+    size_t i = 0;
+    int negative = 0;
+    uint32_t result = 0;
+
+    if (at_tok_next_trimmed(tok, &f, &n) != 0 || n == 0) {
+        return -1;
+    }
+
+    if (f[0] == '-' || f[0] == '+') {
+        negative = (f[0] == '-');
+        i++;
+    }
+    if (i == n) {
+        return -1;  // Sign only
+    }
+
+    uint32_t limit = (uint32_t)INT_MAX + (negative ? 1U : 0U);
+
+    for (; i < n; i++) {
+        if (f[i] < '0' || f[i] > '9') {
+            return -1;
+        }
+
+        uint32_t digit = (uint32_t)(f[i] - '0');
+        if (result > (limit - digit) / 10U) {
+            return -1;  // Out of range
+        }
+        result = result * 10U + digit;
+    }
+
+    *value = negative ? (int)(0U - result) : (int)result;
+    return 0;
+}
+
+// Copy the next field without its double quotes into buf (null-terminated).
+// Returns the length of the string, or -1 if the field is missing or does not fit.
+int at_tok_str(at_tok_t *tok, char *buf, size_t size)
+{
+    const char *f;
+    size_t n;
+
+    if (buf == NULL || size == 0 || at_tok_next_trimmed(tok, &f, &n) != 0 || n >= size) {
+        return -1;
+    }
+
+    memcpy(buf, f, n);
+    buf[n] = '\0';
+    return (int)n;
+}
+
+// Copy the next field as dotted IPv4 address (quotes optional) into buf (null-terminated).
+// Returns the length of the address (0 for an empty field), or -1 if the field is missing,
+// not an IPv4 address or does not fit.
+int at_tok_ipv4(at_tok_t *tok, char *buf, size_t size)
+{
+    const char *f;
+    size_t n;
+    uint8_t dots = 0;
+    uint16_t octet = 0;
+    uint8_t digits = 0;
+
+    if (buf == NULL || size == 0 || at_tok_next_trimmed(tok, &f, &n) != 0 || n >= size) {
+        return -1;
+    }
+
+    for (size_t i = 0; i < n; i++) {
+        if (f[i] >= '0' && f[i] <= '9') {
+            octet = octet * 10 + (f[i] - '0');
+            if (++digits > 3 || octet > 255) {
+                return -1;
+            }
+        } else if (f[i] == '.' && digits > 0 && dots < 3) {
+            dots++;
+            digits = 0;
+            octet = 0;
+        } else {
+            return -1;
+        }
+    }
+
+    if (n > 0 && (dots != 3 || digits == 0)) {
+        return -1;
+    }
+
+    memcpy(buf, f, n);
+    buf[n] = '\0';
+    return (int)n;
+}
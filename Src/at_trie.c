@@ -0,0 +1,237 @@
+// Generated by tools/gen_at_trie.py from Inc/at_status.def - do not edit.
+// Prefix trie of the AT response lines: at_trie_classify() walks it once over the
+// leading bytes of a line and returns the status of the longest matching prefix.
+
+#include "at_trie.h"
+
+#include <stdint.h>
+
+#define AT_TRIE_NODES   153
+#define AT_TRIE_EDGES   152
+
+typedef struct {
+    uint16_t first_edge;    // Edges of the node: [first_edge, first_edge + edge_count)
+    uint8_t edge_count;
+    uint8_t status;         // AtResponseStatus_t of the prefix ending here, or AT_RX_PARTIAL
+} at_trie_node_t;
+
+static const at_trie_node_t at_trie_nodes[AT_TRIE_NODES] = {
+    {   0,  9, AT_RX_PARTIAL       },  // ""
+    {   9,  2, AT_RX_PARTIAL       },  // "+"
+    {  11,  1, AT_RX_PARTIAL       },  // "C"
+    {  12,  1, AT_RX_PARTIAL       },  // "D"
+    {  13,  1, AT_RX_PARTIAL       },  // "E"
+    {  14,  1, AT_RX_PARTIAL       },  // "N"
+    {  15,  1, AT_RX_PARTIAL       },  // "O"
+    {  16,  1, AT_RX_PARTIAL       },  // "P"
+    {  17,  2, AT_RX_PARTIAL       },  // "R"
+    {  19,  1, AT_RX_PARTIAL       },  // "S"
+    {  20,  5, AT_RX_PARTIAL       },  // "+C"
+    {  25,  1, AT_RX_PARTIAL       },  // "+H"
+    {  26,  1, AT_RX_PARTIAL       },  // "CO"
+    {  27,  1, AT_RX_PARTIAL       },  // "DO"
+    {  28,  1, AT_RX_PARTIAL       },  // "ER"
+    {  29,  1, AT_RX_PARTIAL       },  // "NO"
+    {  30,  0, AT_OK               },  // "OK"
+    {  30,  1, AT_RX_PARTIAL       },  // "PB"
+    {  31,  1, AT_RX_PARTIAL       },  // "RD"
+    {  32,  1, AT_RX_PARTIAL       },  // "RI"
+    {  33,  1, AT_RX_PARTIAL       },  // "SM"
+    {  34,  3, AT_RX_PARTIAL       },  // "+CG"
+    {  37,  2, AT_RX_PARTIAL       },  // "+CM"
+    {  39,  1, AT_RX_PARTIAL       },  // "+CP"
+    {  40,  1, AT_RX_PARTIAL       },  // "+CR"
+    {  41,  1, AT_RX_PARTIAL       },  // "+CS"
+    {  42,  1, AT_RX_PARTIAL       },  // "+HT"
+    {  43,  1, AT_RX_PARTIAL       },  // "CON"
+    {  44,  1, AT_RX_PARTIAL       },  // "DOW"
+    {  45,  1, AT_RX_PARTIAL       },  // "ERR"
+    {  46,  1, AT_RX_PARTIAL       },  // "NO "
+    {  47,  1, AT_RX_PARTIAL       },  // "PB "
+    {  48,  0, AT_URC_RDY          },  // "RDY"
+    {  48,  1, AT_RX_PARTIAL       },  // "RIN"
+    {  49,  1, AT_RX_PARTIAL       },  // "SMS"
+    {  50,  2, AT_RX_PARTIAL       },  // "+CGA"
+    {  52,  1, AT_RX_PARTIAL       },  // "+CGE"
+    {  53,  2, AT_RX_PARTIAL       },  // "+CGP"
+    {  55,  1, AT_RX_PARTIAL       },  // "+CME"
+    {  56,  1, AT_RX_PARTIAL       },  // "+CMS"
+    {  57,  1, AT_RX_PARTIAL       },  // "+CPI"
+    {  58,  1, AT_RX_PARTIAL       },  // "+CRE"
+    {  59,  1, AT_RX_PARTIAL       },  // "+CSQ"
+    {  60,  1, AT_RX_PARTIAL       },  // "+HTT"
+    {  61,  1, AT_RX_PARTIAL       },  // "CONN"
+    {  62,  1, AT_RX_PARTIAL       },  // "DOWN"
+    {  63,  1, AT_RX_PARTIAL       },  // "ERRO"
+    {  64,  1, AT_RX_PARTIAL       },  // "NO C"
+    {  65,  1, AT_RX_PARTIAL       },  // "PB D"
+    {  66,  0, AT_URC_RING         },  // "RING"
+    {  66,  1, AT_RX_PARTIAL       },  // "SMS "
+    {  67,  1, AT_RX_PARTIAL       },  // "+CGAC"
+    {  68,  1, AT_RX_PARTIAL       },  // "+CGAT"
+    {  69,  1, AT_RX_PARTIAL       },  // "+CGEV"
+    {  70,  1, AT_RX_PARTIAL       },  // "+CGPA"
+    {  71,  2, AT_RX_PARTIAL       },  // "+CGPS"
+    {  73,  1, AT_RX_PARTIAL       },  // "+CME "
+    {  74,  1, AT_RX_PARTIAL       },  // "+CMS "
+    {  75,  1, AT_RX_PARTIAL       },  // "+CPIN"
+    {  76,  1, AT_RX_PARTIAL       },  // "+CREG"
+    {  77,  1, AT_RX_PARTIAL       },  // "+CSQ:"
+    {  78,  1, AT_RX_PARTIAL       },  // "+HTTP"
+    {  79,  1, AT_RX_PARTIAL       },  // "CONNE"
+    {  80,  1, AT_RX_PARTIAL       },  // "DOWNL"
+    {  81,  0, AT_ERROR            },  // "ERROR"
+    {  81,  1, AT_RX_PARTIAL       },  // "NO CA"
+    {  82,  1, AT_RX_PARTIAL       },  // "PB DO"
+    {  83,  1, AT_RX_PARTIAL       },  // "SMS D"
+    {  84,  1, AT_RX_PARTIAL       },  // "+CGACT"
+    {  85,  1, AT_RX_PARTIAL       },  // "+CGATT"
+    {  86,  1, AT_RX_PARTIAL       },  // "+CGEV:"
+    {  87,  1, AT_RX_PARTIAL       },  // "+CGPAD"
+    {  88,  1, AT_RX_PARTIAL       },  // "+CGPS:"
+    {  89,  1, AT_RX_PARTIAL       },  // "+CGPSI"
+    {  90,  1, AT_RX_PARTIAL       },  // "+CME E"
+    {  91,  1, AT_RX_PARTIAL       },  // "+CMS E"
+    {  92,  1, AT_RX_PARTIAL       },  // "+CPIN:"
+    {  93,  1, AT_RX_PARTIAL       },  // "+CREG:"
+    {  94,  0, AT_INFO_CSQ         },  // "+CSQ: "
+    {  94,  1, AT_RX_PARTIAL       },  // "+HTTPA"
+    {  95,  1, AT_RX_PARTIAL       },  // "CONNEC"
+    {  96,  1, AT_RX_PARTIAL       },  // "DOWNLO"
+    {  97,  1, AT_RX_PARTIAL       },  // "NO CAR"
+    {  98,  1, AT_RX_PARTIAL       },  // "PB DON"
+    {  99,  1, AT_RX_PARTIAL       },  // "SMS DO"
+    { 100,  1, AT_RX_PARTIAL       },  // "+CGACT:"
+    { 101,  1, AT_RX_PARTIAL       },  // "+CGATT:"
+    { 102,  0, AT_URC_CGEV         },  // "+CGEV: "
+    { 102,  1, AT_RX_PARTIAL       },  // "+CGPADD"
+    { 103,  0, AT_INFO_CGPS        },  // "+CGPS: "
+    { 103,  1, AT_RX_PARTIAL       },  // "+CGPSIN"
+    { 104,  1, AT_RX_PARTIAL       },  // "+CME ER"
+    { 105,  1, AT_RX_PARTIAL       },  // "+CMS ER"
+    { 106,  3, AT_RX_PARTIAL       },  // "+CPIN: "
+    { 109,  0, AT_INFO_CREG        },  // "+CREG: "
+    { 109,  1, AT_RX_PARTIAL       },  // "+HTTPAC"
+    { 110,  0, AT_CONNECT          },  // "CONNECT"
+    { 110,  1, AT_RX_PARTIAL       },  // "DOWNLOA"
+    { 111,  1, AT_RX_PARTIAL       },  // "NO CARR"
+    { 112,  0, AT_URC_PB_DONE      },  // "PB DONE"
+    { 112,  1, AT_RX_PARTIAL       },  // "SMS DON"
+    { 113,  0, AT_INFO_CGACT       },  // "+CGACT: "
+    { 113,  0, AT_INFO_CGATT       },  // "+CGATT: "
+    { 113,  1, AT_RX_PARTIAL       },  // "+CGPADDR"
+    { 114,  1, AT_RX_PARTIAL       },  // "+CGPSINF"
+    { 115,  1, AT_RX_PARTIAL       },  // "+CME ERR"
+    { 116,  1, AT_RX_PARTIAL       },  // "+CMS ERR"
+    { 117,  1, AT_RX_PARTIAL       },  // "+CPIN: P"
+    { 118,  1, AT_RX_PARTIAL       },  // "+CPIN: R"
+    { 119,  1, AT_RX_PARTIAL       },  // "+CPIN: S"
+    { 120,  1, AT_RX_PARTIAL       },  // "+HTTPACT"
+    { 121,  0, AT_DOWNLOAD_READY   },  // "DOWNLOAD"
+    { 121,  1, AT_RX_PARTIAL       },  // "NO CARRI"
+    { 122,  0, AT_URC_SMS_DONE     },  // "SMS DONE"
+    { 122,  1, AT_RX_PARTIAL       },  // "+CGPADDR:"
+    { 123,  1, AT_RX_PARTIAL       },  // "+CGPSINFO"
+    { 124,  1, AT_RX_PARTIAL       },  // "+CME ERRO"
+    { 125,  1, AT_RX_PARTIAL       },  // "+CMS ERRO"
+    { 126,  1, AT_RX_PARTIAL       },  // "+CPIN: PH"
+    { 127,  1, AT_RX_PARTIAL       },  // "+CPIN: RE"
+    { 128,  1, AT_RX_PARTIAL       },  // "+CPIN: SI"
+    { 129,  1, AT_RX_PARTIAL       },  // "+HTTPACTI"
+    { 130,  1, AT_RX_PARTIAL       },  // "NO CARRIE"
+    { 131,  0, AT_INFO_CGPADDR     },  // "+CGPADDR: "
+    { 131,  1, AT_RX_PARTIAL       },  // "+CGPSINFO:"
+    { 132,  1, AT_RX_PARTIAL       },  // "+CME ERROR"
+    { 133,  1, AT_RX_PARTIAL       },  // "+CMS ERROR"
+    { 134,  1, AT_RX_PARTIAL       },  // "+CPIN: PH-"
+    { 135,  1, AT_RX_PARTIAL       },  // "+CPIN: REA"
+    { 136,  1, AT_RX_PARTIAL       },  // "+CPIN: SIM"
+    { 137,  1, AT_RX_PARTIAL       },  // "+HTTPACTIO"
+    { 138,  0, AT_NO_CARRIER       },  // "NO CARRIER"
+    { 138,  0, AT_INFO_CGPSINFO    },  // "+CGPSINFO: "
+    { 138,  0, AT_CME_ERROR        },  // "+CME ERROR:"
+    { 138,  0, AT_CMS_ERROR        },  // "+CMS ERROR:"
+    { 138,  1, AT_RX_PARTIAL       },  // "+CPIN: PH-S"
+    { 139,  1, AT_RX_PARTIAL       },  // "+CPIN: READ"
+    { 140,  1, AT_RX_PARTIAL       },  // "+CPIN: SIM "
+    { 141,  1, AT_RX_PARTIAL       },  // "+HTTPACTION"
+    { 142,  1, AT_RX_PARTIAL       },  // "+CPIN: PH-SI"
+    { 143,  0, AT_CPIN_READY       },  // "+CPIN: READY"
+    { 143,  2, AT_RX_PARTIAL       },  // "+CPIN: SIM P"
+    { 145,  1, AT_RX_PARTIAL       },  // "+HTTPACTION:"
+    { 146,  1, AT_RX_PARTIAL       },  // "+CPIN: PH-SIM"
+    { 147,  1, AT_RX_PARTIAL       },  // "+CPIN: SIM PI"
+    { 148,  1, AT_RX_PARTIAL       },  // "+CPIN: SIM PU"
+    { 149,  0, AT_HTTP_ACTION      },  // "+HTTPACTION: "
+    { 149,  1, AT_RX_PARTIAL       },  // "+CPIN: PH-SIM "
+    { 150,  0, AT_CPIN_SIM_PIN     },  // "+CPIN: SIM PIN"
+    { 150,  0, AT_CPIN_SIM_PUK     },  // "+CPIN: SIM PUK"
+    { 150,  1, AT_RX_PARTIAL       },  // "+CPIN: PH-SIM P"
+    { 151,  1, AT_RX_PARTIAL       },  // "+CPIN: PH-SIM PI"
+    { 152,  0, AT_CPIN_PH_SIM_PIN  },  // "+CPIN: PH-SIM PIN"
+};
+
+// Character and target node of every edge
+static const char at_trie_edge_char[AT_TRIE_EDGES] = {
+    '+', 'C', 'D', 'E', 'N', 'O', 'P', 'R', 'S', 'C', 'H', 'O',
+    'O', 'R', 'O', 'K', 'B', 'D', 'I', 'M', 'G', 'M', 'P', 'R',
+    'S', 'T', 'N', 'W', 'R', ' ', ' ', 'Y', 'N', 'S', 'A', 'E',
+    'P', 'E', 'S', 'I', 'E', 'Q', 'T', 'N', 'N', 'O', 'C', 'D',
+    'G', ' ', 'C', 'T', 'V', 'A', 'S', ' ', ' ', 'N', 'G', ':',
+    'P', 'E', 'L', 'R', 'A', 'O', 'D', 'T', 'T', ':', 'D', ':',
+    'I', 'E', 'E', ':', ':', ' ', 'A', 'C', 'O', 'R', 'N', 'O',
+    ':', ':', ' ', 'D', ' ', 'N', 'R', 'R', ' ', ' ', 'C', 'T',
+    'A', 'R', 'E', 'N', ' ', ' ', 'R', 'F', 'R', 'R', 'P', 'R',
+    'S', 'T', 'D', 'I', 'E', ':', 'O', 'O', 'O', 'H', 'E', 'I',
+    'I', 'E', ' ', ':', 'R', 'R', '-', 'A', 'M', 'O', 'R', ' ',
+    ':', ':', 'S', 'D', ' ', 'N', 'I', 'Y', 'P', ':', 'M', 'I',
+    'U', ' ', ' ', 'N', 'K', 'P', 'I', 'N',
+};
+
+static const uint16_t at_trie_edge_next[AT_TRIE_EDGES] = {
+      1,   2,   3,   4,   5,   6,   7,   8,   9,  10,  11,  12,
+     13,  14,  15,  16,  17,  18,  19,  20,  21,  22,  23,  24,
+     25,  26,  27,  28,  29,  30,  31,  32,  33,  34,  35,  36,
+     37,  38,  39,  40,  41,  42,  43,  44,  45,  46,  47,  48,
+     49,  50,  51,  52,  53,  54,  55,  56,  57,  58,  59,  60,
+     61,  62,  63,  64,  65,  66,  67,  68,  69,  70,  71,  72,
+     73,  74,  75,  76,  77,  78,  79,  80,  81,  82,  83,  84,
+     85,  86,  87,  88,  89,  90,  91,  92,  93,  94,  95,  96,
+     97,  98,  99, 100, 101, 102, 103, 104, 105, 106, 107, 108,
+    109, 110, 111, 112, 113, 114, 115, 116, 117, 118, 119, 120,
+    121, 122, 123, 124, 125, 126, 127, 128, 129, 130, 131, 132,
+    133, 134, 135, 136, 137, 138, 139, 140, 141, 142, 143, 144,
+    145, 146, 147, 148, 149, 150, 151, 152,
+};
+
+// Classify a single AT-Response line (without terminator)
+AtResponseStatus_t at_trie_classify(const char *line, size_t len)
+{
+    AtResponseStatus_t status = AT_RX_PARTIAL;  // no match, not a status line
+    uint16_t node = 0;
+
+    // Check input parameters
+    if (line == NULL) {
+        return AT_INVALID_PARAM;
+    }
+
+    for (size_t i = 0; i < len; i++) {
+        const at_trie_node_t *n = &at_trie_nodes[node];
+        uint16_t edge = n->first_edge;
+        uint16_t end = n->first_edge + n->edge_count;
+
+        while (edge < end && at_trie_edge_char[edge] != line[i]) {
+            edge++;
+        }
+        if (edge == end) {
+            break;      // No longer prefix possible
+        }
+
+        node = at_trie_edge_next[edge];
+        if (at_trie_nodes[node].status != AT_RX_PARTIAL) {
+            status = (AtResponseStatus_t)at_trie_nodes[node].status;
+        }
+    }
+
+    return status;
+}
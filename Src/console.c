@@ -0,0 +1,203 @@
+#include "console.h"
+
+#include <stdio.h>
+#include <string.h>
+
+
+// Control characters handled by the line editor
+#define CON_CTRL_C      0x03    // Discard the current line
+#define CON_BACKSPACE   0x08
+#define CON_ESC         0x1B    // Start of a terminal escape sequence (arrow keys etc.), ignored
+#define CON_DEL         0x7F    // Sent by most terminals for the backspace key
+
+typedef struct {
+    const console_cmd_t *cmds;
+    size_t count;
+} console_table_t;
+
+static struct {
+    uart_port_t port;
+    const char *prompt;
+    char line[CONSOLE_LINE_MAX];
+    size_t len;
+    uint8_t esc;            // Number of escape sequence bytes still to skip
+    uint8_t last_cr;        // Last character was CR (swallow the LF of a CR/LF pair)
+    console_table_t tables[CONSOLE_TABLES_MAX];
+    size_t table_count;
+    uint8_t initialized;
+} console;
+
+static int console_cmd_help(int argc, char *argv[]);
+
+// Commands every console provides
+static const console_cmd_t console_builtin_cmds[] = {
+    {"help", "List all commands", console_cmd_help},
+};
+
+// Show the prompt. stdout is line buffered, so flush the unterminated prompt line.
+static void console_prompt(void)
+{
+    printf("%s", console.prompt);
+    fflush(stdout);
+}
+
+// Initialize the console on a UART port, which must already be initialized (RX by interrupt or DMA)
+void console_init(uart_port_t port, const char *prompt)
+{
+    console.port = port;
+    console.prompt = (prompt != NULL) ? prompt : "> ";
+    console.len = 0;
+    console.esc = 0;
+    console.last_cr = 0;
+    console.table_count = 0;
+    console.initialized = 1;
+
+    console_register(console_builtin_cmds, sizeof(console_builtin_cmds) / sizeof(console_builtin_cmds[0]));
+
+    printf("\r\nDebug console ready, type 'help' for a list of commands.\r\n");
+    console_prompt();
+}
+
+// Register a table of commands. The table must stay valid (e.g. static const).
+// Returns 0 on success, -1 if the maximum number of tables is reached.
+int console_register(const console_cmd_t *cmds, size_t count)
+{
+    if (cmds == NULL || count == 0 || console.table_count >= CONSOLE_TABLES_MAX) {
+        return -1;
+    }
+
+    console.tables[console.table_count].cmds = cmds;
+    console.tables[console.table_count].count = count;
+    console.table_count++;
+
+    return 0;
+}
+
+// Look up a command by name in all registered tables
+static const console_cmd_t *console_find(const char *name)
+{
+    for (size_t t = 0; t < console.table_count; t++) {
+        for (size_t i = 0; i < console.tables[t].count; i++) {
+            if (strcmp(console.tables[t].cmds[i].name, name) == 0) {
+                return &console.tables[t].cmds[i];
+            }
+        }
+    }
+    return NULL;
+}
+
+// Split the line into words (in place) and run the matching command
+static void console_execute(char *line)
+{
+    char *argv[CONSOLE_ARGS_MAX];
+    int argc = 0;
+    char *p = line;
+
+    while (*p != '\0' && argc < CONSOLE_ARGS_MAX) {
+        while (*p == ' ') {
+            *p++ = '\0';
+        }
+        if (*p == '\0') {
+            break;
+        }
+        argv[argc++] = p;
+        while (*p != ' ' && *p != '\0') {
+            p++;
+        }
+    }
+
+    if (argc == 0) {
+        return;     // Empty line
+    }
+
+    const console_cmd_t *cmd = console_find(argv[0]);
+    if (cmd == NULL) {
+        printf("Unknown command '%s', type 'help'.\r\n", argv[0]);
+        return;
+    }
+
+    int rv = cmd->handler(argc, argv);
+    if (rv != 0) {
+        printf("%s failed. Status code: %d.\r\n", argv[0], rv);
+    }
+}
+
+// Feed one received character into the line editor
+static void console_input(char ch)
+{
+    // Skip the rest of an escape sequence ("ESC [ x")
+    if (console.esc > 0) {
+        console.esc--;
+        return;
+    }
+
+    // A CR/LF pair ends only one line
+    if (ch == '\n' && console.last_cr) {
+        console.last_cr = 0;
+        return;
+    }
+    console.last_cr = (ch == '\r');
+
+    switch (ch) {
+        case '\r':
+        case '\n': {
+            printf("\r\n");
+            console.line[console.len] = '\0';
+            console_execute(console.line);
+            console.len = 0;
+            console_prompt();
+        } break;
+        case CON_BACKSPACE:
+        case CON_DEL: {
+            if (console.len > 0) {
+                console.len--;
+                printf("\b \b");    // Erase the character on the terminal
+                fflush(stdout);
+            }
+        } break;
+        case CON_CTRL_C: {
+            console.len = 0;
+            printf("^C\r\n");
+            console_prompt();
+        } break;
+        case CON_ESC: {
+            console.esc = 2;
+        } break;
+        default: {
+            // Printable characters only, the last slot is kept for the terminator
+            if (ch >= ' ' && ch < CON_DEL && console.len < (CONSOLE_LINE_MAX - 1)) {
+                console.line[console.len++] = ch;
+                putchar(ch);    // Echo
+                fflush(stdout);
+            }
+        } break;
+    }
+}
+
+// Process all characters received since the last call. Never blocks; call it from the main loop.
+void console_poll(void)
+{
+    int ch;
+
+    if (!console.initialized) {
+        return;
+    }
+
+    while ((ch = uart_read_nb(console.port)) >= 0) {
+        console_input((char)ch);
+    }
+}
+
+// Built-in: list all registered commands
+static int console_cmd_help(int argc, char *argv[])
+{
+    (void)argc;
+    (void)argv;
+
+    for (size_t t = 0; t < console.table_count; t++) {
+        for (size_t i = 0; i < console.tables[t].count; i++) {
+            printf("  %-12s %s\r\n", console.tables[t].cmds[i].name, console.tables[t].cmds[i].help);
+        }
+    }
+    return 0;
+}
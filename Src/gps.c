@@ -1,26 +1,117 @@
 #include "gps.h"
-#include "my_stdio.h"
 
 #include <stdio.h>
-#include <stdlib.h>
 #include <string.h>
 
-// Forward declarations
-float nmea_to_decimal(float value, char dir);
+#define NMEA_MINUTE_DIGITS  6           // Fraction digits of the minutes used (1e-6 min < 1e-7 degrees)
 
-float nmea_to_decimal(float value, char dir) {
-    int degrees = (int)(value / 100.0);
-    float minutes = value - (degrees * 100.0);
-    float decimal = degrees + (minutes / 60.0);
+// Read a decimal number "<int>[.<fraction>]" with min_int..max_int integer digits.
+// The fraction is scaled to frac_digits digits (padded with zeros, extra digits are cut off).
+// Returns the position after the number, NULL if p is NULL or the number is malformed.
+static const char *gps_scan_decimal(const char *p, uint8_t min_int, uint8_t max_int, uint8_t frac_digits,
+                                    uint32_t *whole, uint32_t *frac)
+{
+    uint8_t digits = 0;
+
+    if (p == NULL) {
+        return NULL;
+    }
+
+    *whole = 0;
+    while (*p >= '0' && *p <= '9') {
+        if (++digits > max_int) {
+            return NULL;
+        }
+        *whole = *whole * 10 + (uint32_t)(*p++ - '0');
+    }
+    if (digits < min_int) {
+        return NULL;
+    }
+
+    *frac = 0;
+    digits = 0;
+    if (*p == '.') {
+        p++;
+        while (*p >= '0' && *p <= '9') {
+            if (digits < frac_digits) {
+                *frac = *frac * 10 + (uint32_t)(*p - '0');
+                digits++;
+            }
+            p++;
+        }
+    }
+    while (digits++ < frac_digits) {
+        *frac *= 10;
+    }
+
+    return p;
+}
+
+// Read one of the given characters. Returns the position after it, NULL if it does not match.
+static const char *gps_scan_char(const char *p, const char *accept, char *ch)
+{
+    if (p == NULL || *p == '\0' || strchr(accept, *p) == NULL) {
+        return NULL;
+    }
+
+    *ch = *p;
+    return p + 1;
+}
+
+// Skip the field separator. Returns the position after it, NULL if there is none.
+static inline const char *gps_scan_comma(const char *p)
+{
+    return (p != NULL && *p == ',') ? p + 1 : NULL;
+}
 
-    if (dir == 'S' || dir == 'W') {
-        decimal = -decimal;
+// Combine the NMEA (d)ddmm and minute fraction (1e-6) with the direction into 1e-7 degrees.
+// With the minutes in 1e-6 units, 1e-7 degrees = minutes / 6 (rounded).
+static int nmea_coord(uint32_t whole, uint32_t fraction, char dir, int32_t *coord)
+{
+    uint32_t max_degrees = (dir == 'N' || dir == 'S') ? 90 : 180;
+    uint32_t degrees = whole / 100;
+    uint32_t minutes = (whole % 100) * 1000000UL + fraction;   // 1e-6 minutes
+
+    if (minutes >= 60000000UL || degrees > max_degrees || (degrees == max_degrees && minutes > 0)) {
+        return -1;
     }
 
-    return decimal;
+    int32_t value = (int32_t)(degrees * (uint32_t)GPS_COORD_SCALE + (minutes + 3) / 6);
+    *coord = (dir == 'S' || dir == 'W') ? -value : value;
+
+    return 0;
 }
 
-// Parses GPS info string into the given GPS data structure
+// Format a coordinate in 1e-7 degrees as decimal degrees ("-12.3456789") without floating point.
+// buf must hold GPS_COORD_STR_LEN characters. Returns buf.
+char *coord_to_str(char *buf, int32_t coord)
+{
+    // Magnitude in unsigned arithmetic, INT32_MIN has no positive counterpart
+    uint32_t magnitude = (coord < 0) ? (0U - (uint32_t)coord) : (uint32_t)coord;
+
+    snprintf(buf, GPS_COORD_STR_LEN, "%s%lu.%07lu", (coord < 0) ? "-" : "",
+             (unsigned long)(magnitude / GPS_COORD_SCALE), (unsigned long)(magnitude % GPS_COORD_SCALE));
+    return buf;
+}
+
+// Print a GPS data structure (separate function: keeps the print buffers off the parser's stack)
+static void gps_print_data(const gps_data_t *data)
+{
+    char lat_buf[GPS_COORD_STR_LEN];
+    char lon_buf[GPS_COORD_STR_LEN];
+
+    printf("Latitude: %s, Longitude: %s, Date: %02u/%02u/%02u, "
+           "Time: %02u:%02u:%02u, Altitude: %u m, Speed: %u km/h\r\n",
+           coord_to_str(lat_buf, data->latitude),
+           coord_to_str(lon_buf, data->longitude),
+           data->day, data->month, data->year,
+           data->hour, data->minute, data->second,
+           data->altitude, data->speed);
+}
+
+// Parses the +CGPSINFO payload into the given GPS data structure in a single pass:
+// <lat>,<N|S>,<lon>,<E|W>,<ddmmyy>,<hhmmss[.s]>,<alt>,<speed>[,<course>]
+// gps_data is only written if the whole line is valid.
 int parse_gps_info(const char *gps_info, gps_data_t *gps_data, uint8_t debug)
 {
     // Input parameter check
@@ -29,78 +120,187 @@ int parse_gps_info(const char *gps_info, gps_data_t *gps_data, uint8_t debug)
         return -1;
     }
 
-    // Local buffers for data extraction
-    char lat_str[16], lon_str[16];
-    char alt_str[16], speed_str[16];
-    char date_str[16], time_str[16];
-    char ns, ew;
-    int day, month, year;
-    int hour, minute, second;
-
-    // Initial extraction <lat>,<N|S>,<lon>,<E|W>,<date>,<time>,<alt>,<speed>,
-    int scan_count = sscanf(
-        gps_info,
-        "%15[^,],%c,%15[^,],%c,%15[^,],%15[^,],%15[^,],%15[^,],",
-        lat_str, &ns,
-        lon_str, &ew,
-        date_str, time_str,
-        alt_str, speed_str
-    );
-
-    if (scan_count != 8) {
+    const char *p = gps_info;
+    uint32_t lat_whole, lat_frac, lon_whole, lon_frac;
+    uint32_t date, time, alt, speed, speed_frac, unused;
+    char ns = 0, ew = 0, alt_sign = 0;
+    int32_t latitude, longitude;
+
+    // Fields up to the speed; any error propagates as NULL
+    p = gps_scan_decimal(p, 3, 4, NMEA_MINUTE_DIGITS, &lat_whole, &lat_frac);
+    p = gps_scan_char(gps_scan_comma(p), "NS", &ns);
+    p = gps_scan_decimal(gps_scan_comma(p), 3, 5, NMEA_MINUTE_DIGITS, &lon_whole, &lon_frac);
+    p = gps_scan_char(gps_scan_comma(p), "EW", &ew);
+    p = gps_scan_decimal(gps_scan_comma(p), 6, 6, 0, &date, &unused);
+    p = gps_scan_decimal(gps_scan_comma(p), 6, 6, 0, &time, &unused);
+    p = gps_scan_comma(p);
+    if (p != NULL && *p == '-') {
+        alt_sign = *p++;
+    }
+    p = gps_scan_decimal(p, 1, 5, 0, &alt, &unused);
+    p = gps_scan_decimal(gps_scan_comma(p), 1, 3, 2, &speed, &speed_frac);
+
+    // Optional course, then the end of the line
+    if (p != NULL && *p == ',') {
+        p++;
+        if (*p != '\0') {
+            p = gps_scan_decimal(p, 1, 3, 0, &unused, &unused);
+        }
+    }
+
+    if (p == NULL || *p != '\0') {
         if (debug) {
-            printf("Parsing failed. Read %d fields (Expected 8).\r\n", scan_count);
+            printf("Parsing failed, malformed or missing field.\r\n");
             printf("Raw data causing error: %s\r\n", gps_info);
         }
         return -2;
     }
 
-    // Convert numeric values
-    float latitude  = nmea_to_decimal(atof(lat_str), ns);
-    float longitude = nmea_to_decimal(atof(lon_str), ew);
-    uint16_t altitude = (uint16_t)strtol(alt_str, NULL, 10);
-    float speed = strtof(speed_str, NULL);
+    // Range checks
+    if (nmea_coord(lat_whole, lat_frac, ns, &latitude) != 0 || nmea_coord(lon_whole, lon_frac, ew, &longitude) != 0) {
+        if (debug) printf("GPS coordinates out of range: %s\r\n", gps_info);
+        return -2;
+    }
+
+    uint8_t day = (uint8_t)(date / 10000), month = (uint8_t)(date / 100 % 100);
+    if (day < 1 || day > 31 || month < 1 || month > 12) {
+        if (debug) printf("Invalid GPS date: %06lu\r\n", (unsigned long)date);
+        return -3;
+    }
+
+    uint8_t hour = (uint8_t)(time / 10000), minute = (uint8_t)(time / 100 % 100), second = (uint8_t)(time % 100);
+    if (hour > 23 || minute > 59 || second > 60) {     // 60: leap second
+        if (debug) printf("Invalid GPS time: %06lu\r\n", (unsigned long)time);
+        return -4;
+    }
+
+    speed = speed * 100 + speed_frac;   // Scale to preserve 0.01 km/h resolution
+    if (alt > UINT16_MAX || speed > UINT16_MAX) {
+        if (debug) printf("GPS altitude or speed out of range: %s\r\n", gps_info);
+        return -2;
+    }
 
     // Store in output struct
     gps_data->latitude  = latitude;
     gps_data->longitude = longitude;
-    gps_data->altitude  = altitude;
-    gps_data->speed     = (uint16_t)(speed * 100); // scale to preserve 0.01 km/h resolution
+    gps_data->altitude  = (alt_sign == '-') ? 0 : (uint16_t)alt;   // Below sea level is clamped to 0
+    gps_data->speed     = (uint16_t)speed;
+    gps_data->day       = day;
+    gps_data->month     = month;
+    gps_data->year      = (uint8_t)(date % 100);
+    gps_data->hour      = hour;
+    gps_data->minute    = minute;
+    gps_data->second    = second;
 
-    // Parse date (ddmmyy)
-    scan_count = sscanf(date_str, "%2d%2d%2d", &day, &month, &year);
-    if (scan_count != 3) {
-        if (debug) printf("Failed to parse GPS Date String: '%s'\r\n", date_str);
-        return -3;
+    if (debug) gps_print_data(gps_data);
+
+    return 0; // Success
+}
+
+// Layout of the packed record (big-endian, GPS_PACKET_VERSION 1):
+// version(1) latitude(4) longitude(4) seconds since 2000-01-01 UTC(4) altitude(2) speed(2) CRC-8(1)
+#define GPS_PKT_VERSION     0
+#define GPS_PKT_LATITUDE    1
+#define GPS_PKT_LONGITUDE   5
+#define GPS_PKT_TIME        9
+#define GPS_PKT_ALTITUDE    13
+#define GPS_PKT_SPEED       15
+#define GPS_PKT_CRC         17
+
+_Static_assert(GPS_PKT_CRC + 1 == GPS_PACKET_SIZE, "GPS record layout does not match GPS_PACKET_SIZE");
+
+// Days before the first of each month (non-leap year)
+static const uint16_t gps_month_days[] = {0, 31, 59, 90, 120, 151, 181, 212, 243, 273, 304, 334};
+
+// CRC-8, polynomial 0x07, initial value 0x00
+uint8_t gps_crc8(const uint8_t *buf, uint32_t len)
+{
+    uint8_t crc = 0;
+
+    for (uint32_t i = 0; i < len; i++) {
+        crc ^= buf[i];
+        for (uint8_t bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+        }
     }
+    return crc;
+}
 
-    gps_data->day = (uint8_t)day;
-    gps_data->month = (uint8_t)month;
-    gps_data->year = (uint8_t)year;
+// Seconds since 2000-01-01 00:00:00 UTC of the fix time (year 00..99 = 2000..2099)
+uint32_t gps_to_seconds(const gps_data_t *data)
+{
+    uint32_t year = data->year;
+    uint32_t month = (data->month >= 1 && data->month <= 12) ? data->month : 1;
+    uint32_t days = 365 * year + (year + 3) / 4 + gps_month_days[month - 1] + data->day - 1;
 
-    // Parse time (hhmmss)
-    scan_count = sscanf(time_str, "%2d%2d%2d", &hour, &minute, &second);
-    if (scan_count != 3) {
-        if (debug) printf("Failed to parse GPS Time String to numbers.\r\n");
-        return -4;
+    if (month > 2 && (year % 4) == 0) {
+        days++;     // Leap day of this year (2000 is a leap year)
     }
 
-    gps_data->hour = (uint8_t)hour;
-    gps_data->minute = (uint8_t)minute;
-    gps_data->second = (uint8_t)second;
+    return ((days * 24 + data->hour) * 60 + data->minute) * 60 + data->second;
+}
 
-    if (debug) {
-        lat_str[0] = '\0';  // prepare buffer 
-        lon_str[0] = '\0';
+// Inverse of gps_to_seconds(), sets the date and time fields
+void gps_from_seconds(uint32_t seconds, gps_data_t *data)
+{
+    uint32_t days = seconds / 86400;
+    uint32_t rest = seconds % 86400;
+    uint8_t year = 0;
+    uint8_t month = 1;
 
-        printf("Latitude: %s, Longitude: %s, Date: %02u/%02u/%02u, "
-               "Time: %02u:%02u:%02u, Altitude: %u m, Speed: %u km/h\r\n",
-               float_to_str(lat_str, gps_data->latitude, 6),    // convert back to string for print 
-               float_to_str(lon_str, gps_data->longitude, 6),   // convert back to string for print 
-               gps_data->day, gps_data->month, gps_data->year,
-               gps_data->hour, gps_data->minute, gps_data->second,
-               gps_data->altitude, gps_data->speed);
+    data->hour = (uint8_t)(rest / 3600);
+    data->minute = (uint8_t)(rest / 60 % 60);
+    data->second = (uint8_t)(rest % 60);
+
+    while (days >= ((year % 4) == 0 ? 366U : 365U)) {
+        days -= ((year % 4) == 0) ? 366U : 365U;
+        year++;
+    }
+    while (month < 12) {
+        uint32_t next = gps_month_days[month] + ((month >= 2 && (year % 4) == 0) ? 1 : 0);
+        if (days < next) {
+            break;
+        }
+        month++;
     }
+    days -= gps_month_days[month - 1] + ((month > 2 && (year % 4) == 0) ? 1 : 0);
 
-    return 0; // Success
+    data->year = year;
+    data->month = month;
+    data->day = (uint8_t)(days + 1);
+}
+
+// Pack a GPS fix into a GPS_PACKET_SIZE byte record (big-endian, CRC protected).
+// Returns the number of bytes written.
+uint32_t pack_gps(uint8_t *buf, const gps_data_t *data)
+{
+    buf[GPS_PKT_VERSION] = GPS_PACKET_VERSION;
+    pack_i32(&buf[GPS_PKT_LATITUDE], data->latitude);
+    pack_i32(&buf[GPS_PKT_LONGITUDE], data->longitude);
+    pack_u32(&buf[GPS_PKT_TIME], gps_to_seconds(data));
+    pack_u16(&buf[GPS_PKT_ALTITUDE], data->altitude);
+    pack_u16(&buf[GPS_PKT_SPEED], data->speed);
+    buf[GPS_PKT_CRC] = gps_crc8(buf, GPS_PKT_CRC);
+
+    return GPS_PACKET_SIZE;
+}
+
+// Unpack a record written by pack_gps().
+// Returns 0 on success, -1 on a CRC mismatch, -2 on an unknown version.
+int unpack_gps(const uint8_t *buf, gps_data_t *data)
+{
+    if (gps_crc8(buf, GPS_PKT_CRC) != buf[GPS_PKT_CRC]) {
+        return -1;
+    }
+    if (buf[GPS_PKT_VERSION] != GPS_PACKET_VERSION) {
+        return -2;
+    }
+
+    data->latitude = unpack_i32(&buf[GPS_PKT_LATITUDE]);
+    data->longitude = unpack_i32(&buf[GPS_PKT_LONGITUDE]);
+    gps_from_seconds(unpack_u32(&buf[GPS_PKT_TIME]), data);
+    data->altitude = unpack_u16(&buf[GPS_PKT_ALTITUDE]);
+    data->speed = unpack_u16(&buf[GPS_PKT_SPEED]);
+
+    return 0;
 }
@@ -3,72 +3,322 @@
 #include "systick.h"
 #include "sim7600e.h"
 #include "gps.h"
+#include "console.h"
+#include "at_engine.h"
+#include "track_buffer.h"
+#include "track_codec.h"
 
 #include <stdint.h>
 #include <stdio.h>
 #include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
 
-#define GPS_INFO_MAX_LEN    128
+#define GPS_POLL_INTERVAL_MS        20000   // Default time between two AT+CGPSINFO queries
+#define GPS_POLL_INTERVAL_MIN_MS    1000
+#define HTTP_POST_TIMEOUT_MS        30000   // Max. time for the server's answer
+#define MODEM_INIT_ATTEMPTS         3       // Further attempts resume at the failed bring-up step
+#define MODEM_RECOVER_INTERVAL_MS   10000   // Min. time between two recovery attempts
+#define TRACK_BUFFER_POINTS         256     // Track points kept in SRAM until uploaded
+#define TRACK_UPLOAD_POINTS         32      // Points per upload, also the fill level that starts one
+#define TRACK_UPLOAD_RETRY_MS       60000   // Min. time before the next automatic upload after a failure
+#define TRACK_UPLOAD_BUF_SIZE       (TRACK_BATCH_MIN_LEN + (TRACK_UPLOAD_POINTS - 1) * TRACK_DELTA_MAX_LEN)
+
+// UART ring buffers (sizes must be powers of two)
+#define MODEM_RX_BUF_SIZE   1024
+#define MODEM_TX_BUF_SIZE   256
+#define DBG_RX_BUF_SIZE     128
+#define DBG_TX_BUF_SIZE     2048
+
+static uint8_t modem_rx_buf[MODEM_RX_BUF_SIZE];
+static uint8_t modem_tx_buf[MODEM_TX_BUF_SIZE];
+static uint8_t dbg_rx_buf[DBG_RX_BUF_SIZE];
+static uint8_t dbg_tx_buf[DBG_TX_BUF_SIZE];
+
+// UART1 is used for communication with SIM7600E-Module
+static const uart_config_t modem_uart_config = {
+    .baudrate = 115200,
+    .rx_buf = modem_rx_buf, .rx_buf_size = MODEM_RX_BUF_SIZE,
+    .tx_buf = modem_tx_buf, .tx_buf_size = MODEM_TX_BUF_SIZE,
+    .rx_dma = 1,                        // Circular DMA, IDLE line marks the end of each response burst
+    .tx_dma = 1,
+    .flow_control = 0,                  // Enabled by sim7600e_negotiate_baudrate()
+    .irq_priority = 1,
+    .tx_policy = UART_TX_POLICY_DROP,   // The AT layer applies its own TX timeout
+};
+
+// UART2 is used to print the Debug-Mesages on the Host-PC
+static const uart_config_t dbg_uart_config = {
+    .baudrate = 115200,
+    .rx_buf = dbg_rx_buf, .rx_buf_size = DBG_RX_BUF_SIZE,
+    .tx_buf = dbg_tx_buf, .tx_buf_size = DBG_TX_BUF_SIZE,
+    .rx_dma = 0,                        // Keyboard input, one interrupt per character is fine
+    .tx_dma = 1,
+    .flow_control = 0,
+    .irq_priority = 5,                  // Debug output is less urgent than the modem link
+    .tx_policy = UART_TX_POLICY_BLOCK,  // Never lose debug output
+};
+
+// Application state shared with the console commands and the completion callbacks
+static uint32_t gps_poll_interval_ms = GPS_POLL_INTERVAL_MS;
+static volatile uint8_t upload_requested;
+static uint8_t upload_running;
+static uint8_t upload_failed;
+static uint32_t upload_end_seq;             // Track points below this are released once the upload succeeded
+static uint8_t upload_buf[TRACK_UPLOAD_BUF_SIZE];   // Encoded batch, stays untouched while the upload runs
+static gps_data_t track_points[TRACK_BUFFER_POINTS];
+static track_buffer_t track;
+static uint8_t debug = 1;
+
+// Console: print the UART counters of both ports
+static int cmd_stats(int argc, char *argv[])
+{
+    (void)argc;
+    (void)argv;
+
+    uart_print_stats(MODEM_UART);
+    uart_print_stats(DBG_UART);
+    return 0;
+}
+
+// Console: show or set the GPS polling interval (seconds)
+static int cmd_interval(int argc, char *argv[])
+{
+    if (argc >= 2) {
+        char *end;
+        unsigned long seconds = strtoul(argv[1], &end, 10);
+
+        if (*end != '\0' || (seconds * 1000UL) < GPS_POLL_INTERVAL_MIN_MS) {
+            printf("Usage: interval [seconds >= %d]\r\n", GPS_POLL_INTERVAL_MIN_MS / 1000);
+            return -1;
+        }
+        gps_poll_interval_ms = seconds * 1000UL;
+    }
+
+    printf("GPS polling interval: %lu s\r\n", gps_poll_interval_ms / 1000);
+    return 0;
+}
+
+// Console: upload the buffered track points now (done by the main loop)
+static int cmd_upload(int argc, char *argv[])
+{
+    (void)argc;
+    (void)argv;
+
+    upload_requested = 1;
+    return 0;
+}
+
+// Console: show the fill level of the track point buffer
+static int cmd_track(int argc, char *argv[])
+{
+    (void)argc;
+    (void)argv;
+
+    printf("Track points: %u of %u buffered, %lu overwritten, %lu rejected\r\n",
+           track_buffer_count(&track), track.capacity, track.overwritten, track.rejected);
+    return 0;
+}
+
+// Console: show the recent AT commands and responses
+static int cmd_transcript(int argc, char *argv[])
+{
+    (void)argc;
+    (void)argv;
+
+    at_engine_print_transcript();
+    return 0;
+}
+
+// Console: show how long the phases of the last modem bring-up took
+static int cmd_boot(int argc, char *argv[])
+{
+    (void)argc;
+    (void)argv;
+
+    sim7600e_print_boot_report();
+    return 0;
+}
+
+// Console: show the AT command latency histograms, "latency reset" clears them
+static int cmd_latency(int argc, char *argv[])
+{
+    if (argc > 1) {
+        if (strcmp(argv[1], "reset") != 0) {
+            printf("Usage: latency [reset]\r\n");
+            return -1;
+        }
+        at_engine_reset_stats();
+        return 0;
+    }
+
+    at_engine_print_stats();
+    return 0;
+}
+
+static const console_cmd_t app_cmds[] = {
+    {"stats",       "Show UART error and throughput counters",      cmd_stats},
+    {"interval",    "Show/set GPS polling interval: interval [s]",  cmd_interval},
+    {"upload",      "Upload the buffered track points now",         cmd_upload},
+    {"track",       "Show the track point buffer",                  cmd_track},
+    {"transcript",  "Show the recent AT traffic",                   cmd_transcript},
+    {"boot",        "Show the timing of the last modem bring-up",   cmd_boot},
+    {"latency",     "Show AT command latencies: latency [reset]",   cmd_latency},
+};
+
+// Result of a background AT+CGPSINFO query
+static void gps_poll_done(CgpsState_t state, const char *info, void *ctx)
+{
+    (void)ctx;
+
+    if (state == CGPS_STATE_FIX_AVAILABLE) {
+        gps_data_t gps_data;
+
+        if (parse_gps_info(info, &gps_data, debug) == 0) {
+            track_buffer_push(&track, &gps_data);
+            if (debug) printf("GPS info successfully parse.\r\n");
+        } else {
+            if (debug) printf("Faild to parse GPS info.\r\n");
+        }
+    } else if (state == CGPS_STATE_NO_FIX) {
+        if (debug) printf("No GPS fix available, continue trying...\r\n");
+    } else {
+        if (debug) printf("Failed to get GPS info. Status code: %d \r\n", state);
+    }
+}
+
+// Result of a background upload
+static void upload_done(int result, void *ctx)
+{
+    (void)ctx;
+
+    upload_running = 0;
+    printf("Upload finished. Status code: %d\r\n", result);
+
+    // Keep the points for the next attempt unless the server accepted them
+    upload_failed = (result < 200 || result > 299);
+    if (!upload_failed) {
+        track_buffer_release(&track, upload_end_seq);
+    }
+}
+
+// Encode the oldest track points into one batch and start its upload
+static void track_upload_start(void)
+{
+    track_encoder_t enc;
+    uint16_t count = 0;
+
+    if (track_buffer_count(&track) == 0) {
+        printf("No GPS fix to upload yet.\r\n");
+        return;
+    }
+
+    track_encoder_init(&enc, upload_buf, sizeof(upload_buf));
+    while (count < TRACK_UPLOAD_POINTS && count < track_buffer_count(&track) &&
+           track_encoder_add(&enc, track_buffer_peek(&track, count)) == 0) {
+        count++;
+    }
+    upload_end_seq = track_buffer_oldest(&track) + count;
+
+    // Binary batch (application/octet-stream), see track_codec.h
+    if (sim7600e_http_post_async(upload_buf, track_encoder_finish(&enc),
+                                 HTTP_POST_TIMEOUT_MS, upload_done, NULL, debug) == 0) {
+        upload_running = 1;
+        if (debug) printf("Uploading %u track points.\r\n", count);
+    } else {
+        upload_failed = 1;
+        printf("Upload could not be started.\r\n");
+    }
+}
+
+// Unsolicited modem event (losses of the modem state are recovered by the main loop)
+static void modem_event(Sim7600eEvent_t event, const char *line, size_t len, void *ctx)
+{
+    (void)ctx;
+
+    // Results of the running upload go to upload_done(), this one arrived after its timeout
+    if (event == SIM7600E_EVENT_HTTP) {
+        printf("Late upload result: %.*s\r\n", (int)len, line);
+    }
+}
 
 int main(void)
 { 
     const char *pin = "4949";
     const char *url = "https://89b0716c1a07.ngrok-free.app";
-    uint8_t debug = 1;
-    char gps_info[GPS_INFO_MAX_LEN];
-    char *payload_ptr = gps_info;
     int rv;
 
     // Initialize system tick 
     systick_init();
 
     // Initialize  UART1 to communicate with SIM7600E-Module
-    uart1_init();
+    uart_init(MODEM_UART, &modem_uart_config);
 
     // Initialize UART2 to print message on host-pc (debugging)
-    uart2_init();
+    uart_init(DBG_UART, &dbg_uart_config);
     
     // Initialize stdio to use printf correctly 
     stdio_init();
 
     // Initialize SIM7600E-Module 
-    rv = sim7600e_init(pin, url, debug);
+    sim7600e_set_event_callback(modem_event, NULL);
+    for (uint8_t i = 0; i < MODEM_INIT_ATTEMPTS; i++) {
+        rv = sim7600e_init(pin, url, debug);
+        if (debug) sim7600e_print_boot_report();
+        if (rv == 0) {
+            break;
+        }
+    }
     if (rv) {
         if (debug) printf("Failed to initialize SIM7660E module. Status code: %d", rv);
         // ToDo: turn on the init_error led
         return -1;
     }
 
+    // Track points are kept until uploaded; when full, the oldest points give way to new ones
+    track_buffer_init(&track, track_points, TRACK_BUFFER_POINTS, TRACK_OVERWRITE_OLDEST);
 
-    // Get the first GPS-info 
-    uint32_t delay_ms = 20000;      // Delay between each attempt to get GPS info 
-    uint32_t timeout_ms = 5*60000;   // Total timout 3*60s
-
-    rv = sim7600e_get_gps_fix(&payload_ptr, sizeof(gps_info), delay_ms, timeout_ms, debug);
-    
-    if (rv == 0) {
-        if (debug) printf("Success! GPS data acquired within %lds. \r\n Data: %s \r\n", timeout_ms/1000, payload_ptr);
-    } else if (rv == -3) {
-        if (debug) printf("GPS fix acquisition timed out after %lds.\r\n", timeout_ms/1000);
-    } else {
-        if (debug) printf("Failed to get GPS info due to communication error. Status Code: %d \r\n", rv);
-        return -2;
-    }
-
-    gps_data_t gps_data;
-    rv = parse_gps_info(payload_ptr, &gps_data, debug);
-    if (rv == 0) {
-        if (debug) printf("GPS info successfully parse.\r\n");
-    } else {
-        if (debug) printf("Faild to parse GPS info. Status code: %d\r\n", rv);
-        return -3;
-    }
+    // Debug console on UART2, served from the main loop
+    console_init(DBG_UART, "tracker> ");
+    console_register(app_cmds, sizeof(app_cmds) / sizeof(app_cmds[0]));
 
+    uint32_t last_poll = system_get_tick_ms() - gps_poll_interval_ms;   // Poll right away
+    uint32_t last_recover = system_get_tick_ms();
+    uint32_t last_upload = system_get_tick_ms();
 
-    /* Loop forever */
+    /* Loop forever: console, GPS polling and uploads interleave on the AT engine */
     while (1)
     {
-        
+        console_poll();
+        at_engine_poll();
+        sim7600e_poll();
+
+        // Bring the modem back after a URC reported a loss (resumes at the lost step). The bring-up
+        // runs in the background from sim7600e_poll(); starting it restarts the AT engine,
+        // so wait for the running commands. GPS polls and uploads pause meanwhile.
+        if (sim7600e_init_busy()) {
+            last_recover = system_get_tick_ms();
+        } else if (!sim7600e_ready() && !at_engine_busy() &&
+                   (system_get_tick_ms() - last_recover) >= MODEM_RECOVER_INTERVAL_MS) {
+            if (debug) printf("Modem lost its state, recovering...\r\n");
+            sim7600e_init_start(pin, url, debug);
+            last_recover = system_get_tick_ms();
+        }
+
+        // Query the GPS position once per interval (the result arrives in gps_poll_done())
+        if (!sim7600e_init_busy() && (system_get_tick_ms() - last_poll) >= gps_poll_interval_ms) {
+            if (sim7600e_gps_poll_async(gps_poll_done, NULL, debug) == 0) {
+                last_poll = system_get_tick_ms();
+            }
+        }
+
+        // Upload on request from the console, or once a batch is full (retried after a pause on failure)
+        if (!upload_running && !sim7600e_init_busy() && (upload_requested ||
+            (track_buffer_count(&track) >= TRACK_UPLOAD_POINTS && sim7600e_ready() &&
+             (!upload_failed || (system_get_tick_ms() - last_upload) >= TRACK_UPLOAD_RETRY_MS)))) {
+            upload_requested = 0;
+            last_upload = system_get_tick_ms();
+            track_upload_start();
+        }
     }
 }
-
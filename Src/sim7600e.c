@@ -1,58 +1,30 @@
 #include "sim7600e.h"
 #include "uart.h"
+#include "at_engine.h"
+#include "at_trie.h"
+#include "at_tok.h"
 #include "systick.h"
 
 #include <string.h>
 #include <stdio.h>
 
 
-#define TX_TIMEOUT_MS       100 // TX timeout in miliseconds 
-#define TX_BUF_SIZE         32  // Size for the AT command reques
-#define RX_BUF_SIZE         64  // Size for the AT command response
-#define IPV6_ADDR_MAX_LEN   40  // For full IPv6 address string
-#define HTTP_URL_MAX_LEN    128 // For HTTP-URL strng  
+#define HTTP_DATA_TIMEOUT   "10000" // Time the modem waits for the HTTP body (ms)
 
-typedef struct {
-    const char *string;
-    AtResponseStatus_t status;
-} AtLookupEntry_t;
-
-// The lookup table, prioritized for searching the full response buffer.
-const AtLookupEntry_t StatusLookupTable[] = {
-
-    // ritical Error Codes 
-    {"ERROR\r\n",           AT_ERROR},          // Must be checked before specific errors
-    {"+CME ERROR:",         AT_CME_ERROR},
-    {"+CMS ERROR:",         AT_CMS_ERROR},
-
-    // CREG (Network Registration: Circuit Switched (CS) Group)
-    {"+CREG: ",             AT_INFO_CREG},          // Matches +CREG: <n>,<stat>
-    // CGATT (Network Registration: Packet Switched (PS) Group)
-    {"+CGATT: ",            AT_INFO_CGATT},
-    // CGPADDR (IP Address confirmation)
-    {"+CGPADDR: ",          AT_INFO_CGPADDR},
-
-    // CGPS
-    {"+CGPS: ",             AT_INFO_CGPS},          // Matches +CGPS: <on/off>,<mode>
-    {"+CGPSINFO: ",         AT_INFO_CGPSINFO},      // Matches +CGPSINFO: <data>
-   
-    // CSQ (Signal Quality)
-    {"+CSQ: ",              AT_INFO_CSQ},           // Matches +CSQ: <rssi>,<ber>
-    
-    // CPIN (Fixed strings, easiest to match directly)
-    {"+CPIN: READY",        AT_CPIN_READY},
-    {"+CPIN: SIM PIN",      AT_CPIN_SIM_PIN},
-    {"+CPIN: SIM PUK",      AT_CPIN_SIM_PUK},
-    {"+CPIN: PH-SIM PIN",   AT_CPIN_PH_SIM_PIN},
-    
-    // Generic Information Codes 
-    {"NO CARRIER\r\n",       AT_NO_CARRIER},
-    {"CONNECT\r\n",          AT_CONNECT},
-    {"DOWNLOAD\r\n",         AT_DOWNLOAD_READY},
-    {"OK\r\n",               AT_OK},
-
-    // Sentinel to mark the end of the table
-    {NULL,                   (AtResponseStatus_t)0} 
+#define MODEM_DEFAULT_BAUDRATE  115200  // SIM7600E rate after power-up and after AT+CFUN=1,1
+#define MODEM_HIGH_BAUD_ENABLE  1       // Negotiate a faster link (AT+IPR) once the modem is up
+#define MODEM_TARGET_BAUDRATE   921600  // Upper limit for the negotiated rate
+#define MODEM_HW_FLOW_CONTROL   1       // Use RTS/CTS on the modem link (AT+IFC=2,2)
+
+#define MODEM_BOOT_TIMEOUT_MS       40000   // Upper bound for the boot after AT+CFUN=1,1
+#define MODEM_BOOT_PROBE_START_MS   3000    // First AT probe (the modem needs a moment to go down)
+#define MODEM_BOOT_PROBE_MIN_MS     500     // Backoff between AT probes, doubled up to the max.
+#define MODEM_BOOT_PROBE_MAX_MS     4000
+
+// Rates supported by AT+IPR, fastest first. uart_baudrate_supported() filters the
+// ones the USART1 clock cannot generate accurately enough.
+static const uint32_t ModemBaudrates[] = {
+    3686400, 3200000, 3000000, 921600, 460800, 230400
 };
 
 // Corresponds to the order of CsqRssiState_t enum (0, 1, 2, 3, 4, 5)
@@ -75,875 +47,1287 @@ const char * const BER_STATE_STRINGS[] = {
     "INVALID_PARSE_ERROR"
 };
 
-// Function Pointer Type definitions
-typedef int (*uart_tx_char_t)(int ch);
-typedef int (*uart_rx_char_t)(void);
-
 // Forward declarations
-AtResponseStatus_t send_at(const char *cmd, uint32_t rx_timeout_ms, char *rx_buf, size_t rx_buf_size, uint8_t debug);
-AtResponseStatus_t parse_at_response(const char *response, uint8_t debug);
-int sim7600e_write_command(uart_tx_char_t tx_func_nb, const char *cmd, size_t len, uint32_t timeout_ms);
-char* sim7600e_read_full_response(uart_rx_char_t rx_func_nb, char *out_buf, size_t max_len, uint32_t timeout_ms);
-CregState_t parse_creg_status(const char *response_str);
-CgpsState_t parse_cgps_status(const char *response_str);
-CgpsState_t parse_cgpsinfo_state(char **response_str);
-CsqState_t parse_csq_status(const char *response_str, CsqResult_t *result);
+AtResponseStatus_t send_at(const char *cmd, uint32_t rx_timeout_ms, at_resp_t *response, uint8_t debug);
+AtResponseStatus_t send_at_v(const at_iovec_t *parts, size_t count, uint32_t rx_timeout_ms, at_resp_t *response, uint8_t debug);
+AtResponseStatus_t parse_at_line(const char *line, size_t len);
 int sim7600e_eval_sq_result(CsqResult_t *result, uint8_t debug);
-CgattState_t parse_cgatt_status(const char *response_str);
-CgpaddrState_t parse_cgpaddr_status(const char *response_str, char *ip_addr);
+static int sim7600e_probe(uint8_t attempts, uint8_t debug);
+int sim7600e_sync_baudrate(uint8_t debug);
 
-// Parse single AT-Response line using lookup table
-AtResponseStatus_t parse_at_response(const char *response, uint8_t debug)
+// Classify a single AT-Response line (without terminator). The prefixes are listed in
+// Inc/at_status.def; the build generates the prefix trie walked by at_trie_classify().
+AtResponseStatus_t parse_at_line(const char *line, size_t len)
 {
-    // Check input parameters
-    if (response == NULL) {
-        return AT_INVALID_PARAM;
-    }
+    return at_trie_classify(line, len);
+}
 
-    // Iterate trough every entry in the lookup table
-    for (size_t i = 0;  StatusLookupTable[i].string != NULL; i++) {
+// Convert an unsigned number to decimal text for a command argument. buf needs 11 bytes.
+static char *at_u32_to_str(char *buf, uint32_t value)
+{
+    char *p = &buf[10];
 
-        // Check if the matching string is presented anywhere in the response buffer
-        if (strstr(response, StatusLookupTable[i].string) != NULL) {
+    *p = '\0';
+    do {
+        *--p = (char)('0' + (value % 10U));
+        value /= 10U;
+    } while (value != 0U);
 
-            // Match found, log it and return specific enum status
-            if (debug) printf("<<< %s", response);
-            return StatusLookupTable[i].status;  
-        }
-    }
+    return p;
+}
+
+// Send an AT command and return enum response. response (optional) receives all information lines.
+AtResponseStatus_t send_at(const char *cmd, uint32_t rx_timeout_ms, at_resp_t *response, uint8_t debug)
+{
+    at_iovec_t part = at_str(cmd);
 
-    return AT_RX_PARTIAL;   // no match, keep-reading
+    return send_at_v(&part, 1, rx_timeout_ms, response, debug);
 }
 
-int sim7600e_write_command(uart_tx_char_t tx_func_nb, const char *cmd, size_t len, uint32_t timeout_ms)
+// Send an AT command given in several parts (e.g. constant prefix, user string, constant suffix)
+// and return enum response. The parts are streamed one after the other into the UART TX queue.
+// Blocking wrapper around the AT engine: returns when the command is complete.
+AtResponseStatus_t send_at_v(const at_iovec_t *parts, size_t count, uint32_t rx_timeout_ms, at_resp_t *response, uint8_t debug)
 {
-    int chars_written = 0;
-    
-    // Save the start time 
-    uint32_t start_time = system_get_tick_ms();
+    size_t bytes_to_send = 0;
 
-    for (const char *ptr = cmd; *ptr != '\0' && chars_written < len; ptr++) {
-        
-        int status = -1;
-
-        // Try to send current character 
-        while (status != 0) {
-            
-            status = tx_func_nb(*ptr); // Call the non-blocking write (returns 0 or -1)
-            
-            if (status == 0) {
-                chars_written++;
-                break; // Character sent successfully
-            }
-            
-            // Check if timeout time is exceeded (Overall Timeout Check)
-            if ((system_get_tick_ms() - start_time) >= timeout_ms) {
-                return -1; // Abort transmission
-            }
+    // Checking AT-Command arguments 
+    if (parts == NULL) {
+        if (debug) printf("Error: AT command is empty.\r\n");
+        return AT_INVALID_PARAM;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        if (parts[i].base == NULL && parts[i].len != 0) {
+            if (debug) printf("Error: AT command part %zu is missing.\r\n", i);
+            return AT_INVALID_PARAM;
         }
+        bytes_to_send += parts[i].len;
     }
-    
-    return chars_written;
+
+    if (bytes_to_send == 0) {
+        if (debug) printf("Error: AT command is empty.\r\n");
+        return AT_INVALID_PARAM;
+    }
+
+    // Run the command on the AT engine and wait for its completion
+    at_cmd_t cmd = {
+        .parts = parts, .count = count,
+        .timeout_ms = rx_timeout_ms,
+        .wait_for = AT_RX_PARTIAL,
+        .resp = response,
+        .debug = debug,
+    };
+
+    return at_engine_execute(&cmd);
 }
 
-char *sim7600e_read_full_response(uart_rx_char_t rx_func_nb, char *out_buf, size_t max_len, uint32_t timeout_ms)
+// Evaluate Sqignal Quality results 
+int sim7600e_eval_sq_result(CsqResult_t *result, uint8_t debug)
 {
-    // Input parameter check
-    if (out_buf == NULL || max_len == 0) {
-        return NULL;
+    int rv = 0;
+
+    // Input parameter check 
+    if (result == NULL) {
+        if (debug) printf ("Error: Signal Quality result is null.\r\n");
+        return --rv;
     }
 
-    // Ensure space for at least the null terminator
-    if (max_len == 1) {
-        out_buf[0] = '\0';
-        return NULL;
+    // Evaluate RSSI (Signal Strength)
+    switch (result->rssi_state) {
+        case RSSI_STATE_EXCELLENT:
+        case RSSI_STATE_GOOD: {
+            if (debug) printf("Signal Report: RSSI is %s. (Raw: %d).\r\n", 
+                             RSSI_STATE_STRINGS[result->rssi_state], result->raw_rssi);
+        
+        } break;
+        case RSSI_STATE_UNKNOWN: {
+             if (debug) printf("Error: RSSI is %s (Raw: %d). Cannot establish connection yet. Stopping.\r\n", 
+                             RSSI_STATE_STRINGS[result->rssi_state], result->raw_rssi);
+            return --rv;
+        }
+        case RSSI_STATE_MARGINAL:
+        case RSSI_STATE_MINIMAL:
+        case RSSI_STATE_INVALID:
+        default: {
+             if (debug) printf("Error: RSSI is %s (Raw: %d). Signal too weak/invalid. Stopping.\r\n", 
+                             RSSI_STATE_STRINGS[result->rssi_state], result->raw_rssi);
+            return --rv;
+        }
     }
 
-    size_t i = 0;
-    int received_char;
-    const uint32_t INTER_CHAR_TIMEOUT_MS = 50;
-    uint32_t start_time = system_get_tick_ms();
-    uint32_t last_char_time = system_get_tick_ms(); // Initialize for silence check
+    // Evaluate BER (Bit Error Rate)
+    switch (result->ber_state) {
+        case BER_STATE_EXCELLENT:
+        case BER_STATE_GOOD:
+        case BER_STATE_ACCEPTABLE: {
+            if (debug) printf("Signal Report: BER is %s. (Raw: %d). Quality is OK.\r\n",
+                             BER_STATE_STRINGS[result->ber_state], result->raw_ber);
+        } break;
+        case BER_STATE_UNKNOWN: {
+            // BER 99 is common/acceptable on LTE if RSSI is already determined to be good/excellent.
+            if (debug) printf("Signal Report: BER is %s (Raw: %d). Accepted due to strong RSSI.\r\n", 
+                                BER_STATE_STRINGS[result->ber_state], result->raw_ber);
+        } break;
+        case BER_STATE_POOR:
+        case BER_STATE_INVALID:
+        default: {
+            if (debug) printf("Error: BER is %s (Raw: %d). Poor quality/invalid value. Stopping.\r\n", 
+                             BER_STATE_STRINGS[result->ber_state], result->raw_ber);
+            return --rv;
+        }
+    }
 
-    // Loop as long as the total elapsed time is less than the timeout
-    while ((system_get_tick_ms() - start_time) < timeout_ms) {
+    if (debug) printf("Signal quality check PASSED. Proceeding...\r\n");
+    return 0; // Success
+}
 
-        // 1. SILENCE CHECK (Critical for fixing this bug)
-        if (i > 0 && (system_get_tick_ms() - last_char_time) > INTER_CHAR_TIMEOUT_MS) {
-            break; // Stop reading if the modem is silent.
+// Send "AT" until the modem answers OK. Returns 0 on success, -1 otherwise.
+static int sim7600e_probe(uint8_t attempts, uint8_t debug)
+{
+    for (uint8_t i = 0; i < attempts; i++) {
+        if (send_at("AT\r", 300, NULL, debug) == AT_OK) {
+            return 0;
         }
+    }
+    return -1;
+}
 
-        // Call the non-blocking read
-        received_char = rx_func_nb();
-        
-        if (received_char >= 0) { // Data received successfully
+// Find the rate the modem currently listens on. After an MCU-only reset the modem may still
+// run at a previously negotiated rate, while USART1 starts at MODEM_DEFAULT_BAUDRATE.
+// Returns 0 when the modem answers, -1 if it is silent at every rate.
+int sim7600e_sync_baudrate(uint8_t debug)
+{
+    if (sim7600e_probe(2, debug) == 0) {
+        return 0;
+    }
 
-            // Check against output buffer limit
-            if (i < (max_len - 1)) {
-                
-                out_buf[i++] = (char)received_char; // Store character and increment index
-                out_buf[i] = '\0';                  // Null-terminate the new end
+#if MODEM_HIGH_BAUD_ENABLE
+    // No flow control while searching: a silent modem does not drive CTS, which would hold
+    // back our probes. Only sim7600e_negotiate_baudrate() enables it, after AT+IFC=2,2.
+    uart_set_flow_control(MODEM_UART, 0);
 
-            } else {
-                // Buffer capacity reached. Treat as end of read.
-                break;
-            }
+    for (size_t i = 0; i < sizeof(ModemBaudrates) / sizeof(ModemBaudrates[0]); i++) {
+        if (ModemBaudrates[i] > MODEM_TARGET_BAUDRATE || uart_set_baudrate(MODEM_UART, ModemBaudrates[i]) != 0) {
+            continue;
+        }
+        if (sim7600e_probe(1, debug) == 0) {
+            if (debug) printf("Modem found at %lu baud.\r\n", ModemBaudrates[i]);
+            return 0;
         }
     }
 
-    // Terminate the buffer at the current index
-    out_buf[i] = '\0';
+    // Fall back to the power-up configuration
+    uart_set_baudrate(MODEM_UART, MODEM_DEFAULT_BAUDRATE);
+#endif
 
-    // Check for read failure
-    if ((i == 0) && ((system_get_tick_ms() - start_time) >= timeout_ms)) {
-        return NULL;
-    }
-
-    return out_buf; // return the result pointer 
+    return -1;
 }
 
-// Send an AT command and return enum response
-AtResponseStatus_t send_at(const char *cmd, uint32_t rx_timeout_ms, char *rx_buf, size_t rx_buf_size, uint8_t debug)
+// Switch the modem link to the fastest rate both sides support (up to max_baudrate),
+// with RTS/CTS flow control if MODEM_HW_FLOW_CONTROL is set. The change is temporary
+// on the modem side (AT+IPR, not AT+IPREX): a modem reset returns it to MODEM_DEFAULT_BAUDRATE.
+// Returns the established baudrate; on any failure the link stays at (or returns to) the default rate.
+uint32_t sim7600e_negotiate_baudrate(uint32_t max_baudrate, uint8_t debug)
 {
-    // Checking AT-Command arguments 
-    if (cmd == NULL || *cmd == '\0') {
-        if (debug) printf("Error: AT command is empty.\r\n");
-        return AT_INVALID_PARAM;
-    }
+    char rate_str[11];  // Up to 10 digits + '\0'
+    AtResponseStatus_t resp;
 
-    if (rx_buf == NULL || rx_buf_size == 0) {
-        if (debug) printf("Error: Receive Buffer is empty.\r\n");
-        return AT_INVALID_PARAM;
+#if MODEM_HW_FLOW_CONTROL
+    // Modem: RTS/CTS in both directions
+    resp = send_at("AT+IFC=2,2\r", 500, NULL, debug);
+    if (resp != AT_OK) {
+        if (debug) printf("[IFC] Failed to enable hardware flow control. Status code: %d. Keeping %d baud.\r\n", resp, MODEM_DEFAULT_BAUDRATE);
+        return MODEM_DEFAULT_BAUDRATE;
     }
+    uart_set_flow_control(MODEM_UART, 1);
+#endif
 
-    if (debug == 1) printf(">>> %s\r\n", cmd);  // Print AT-Command (should already include '\r')
+    for (size_t i = 0; i < sizeof(ModemBaudrates) / sizeof(ModemBaudrates[0]); i++) {
+        uint32_t baudrate = ModemBaudrates[i];
 
-    // Send Command with dedicated, short TX timeout
-    size_t bytes_to_send = strlen(cmd);
-    int bytes_send = sim7600e_write_command((uart_tx_char_t)uart1_write_nb, cmd, bytes_to_send, TX_TIMEOUT_MS);
+        if (baudrate > max_baudrate || !uart_baudrate_supported(MODEM_UART, baudrate)) {
+            continue;
+        }
 
-    if (bytes_send < 0) {
-        if (debug) printf("Error: UART write timed out during TX.\r\n");
-        return AT_TIMEOUT;
-    }
+        // The modem answers OK at the old rate and switches afterwards
+        const at_iovec_t ipr_cmd[] = {
+            AT_LIT("AT+IPR="), at_str(at_u32_to_str(rate_str, baudrate)), AT_LIT("\r")
+        };
+        resp = send_at_v(ipr_cmd, sizeof(ipr_cmd) / sizeof(ipr_cmd[0]), 500, NULL, debug);
+        if (resp != AT_OK) {
+            if (debug) printf("[IPR] Modem rejected %lu baud. Status code: %d.\r\n", baudrate, resp);
+            continue;
+        }
 
-    // Check Transmit Status
-    if ((size_t)bytes_send != bytes_to_send) {
-        if (debug) printf("Error: Only %zu of %zu bytes were sent to modem.\r\n", bytes_send, bytes_to_send);
-        return AT_TX_FAILURE;
-    }
+        uart_set_baudrate(MODEM_UART, baudrate);
+        at_engine_flush_rx();    // Drop anything received during the switch
 
-    // Read the response from SIM7600E-Modul
-    char *response = sim7600e_read_full_response((uart_rx_char_t)uart1_read_nb, rx_buf, rx_buf_size, rx_timeout_ms);
-    if (response != NULL) {
-        return parse_at_response(response, debug);
+        if (sim7600e_probe(3, debug) == 0) {
+            if (debug) printf("Modem link running at %lu baud.\r\n", baudrate);
+            return baudrate;
+        }
+
+        // No answer at the new rate: bring both sides back to the default
+        if (debug) printf("[IPR] No response at %lu baud, reverting.\r\n", baudrate);
+        uart_set_baudrate(MODEM_UART, MODEM_DEFAULT_BAUDRATE);
+        if (sim7600e_probe(3, debug) != 0) {
+            break;  // Modem is lost at both rates, let the caller's next command fail
+        }
     }
 
-    if (debug) printf("Error: No response or read timeout.\r\n");
-    return AT_TIMEOUT;
+    return MODEM_DEFAULT_BAUDRATE;
 }
 
-// Parse Network Registration Status response 
-CregState_t parse_creg_status(const char *response_str) {
+// -- Modem bring-up sequence --
+// The bring-up is described by the InitSteps table below and run by sim7600e_init() or, in the background,
+// by sim7600e_init_start() and sim7600e_poll().
+// Each step sends one command (or runs a local action), evaluates the response and
+// selects the next step. Timeouts and retries of the boot are tuned in the table only:
+// there are no fixed settle delays, a step that waits for a modem state polls it with backoff.
+//
+// After an MCU-only reset the modem is often still registered with an active PDP context.
+// The INIT_WARM_* steps check this with single queries and continue with the HTTP setup;
+// the first unhealthy answer falls back to the full reset.
+
+typedef enum {
+    INIT_SYNC = 0,          // Find the rate the modem currently listens on
+    INIT_WARM_CPIN,         // Warm start: SIM ready?
+    INIT_WARM_CREG,         // Warm start: registered?
+    INIT_WARM_CGACT,        // Warm start: PDP context 1 active?
+    INIT_WARM_CGPADDR,      // Warm start: IP address assigned?
+    INIT_RESET,             // AT+CFUN=1,1 and wait for the boot
+    INIT_LINK_DEFAULT,      // Return USART1 to the power-up link settings
+    INIT_BOOT,              // Wait for the boot (URCs and AT probes)
+    INIT_AT,
+    INIT_BAUDRATE,
+    INIT_CPIN_QUERY,
+    INIT_CPIN_UNLOCK,
+    INIT_CPIN_WAIT,         // Wait for the SIM after unlocking
+    INIT_CREG,
+    INIT_CSQ,
+    INIT_CGATT_QUERY,
+    INIT_CGATT_ATTACH,
+    INIT_CGDCONT_DELETE,
+    INIT_CGDCONT_SET,
+    INIT_CGACT,
+    INIT_CGPADDR,
+    INIT_HTTPTERM,
+    INIT_HTTPINIT,
+    INIT_HTTP_CONTENT,
+    INIT_HTTP_URL,
+    INIT_CGPS_QUERY,
+    INIT_CGPS_ENABLE,
+    INIT_STEP_COUNT,
+
+    // Transition targets only
+    INIT_DONE = INIT_STEP_COUNT,
+    INIT_ABORT,
+} InitStep_t;
+
+typedef enum {
+    STEP_OK = 0,    // Continue with on_ok
+    STEP_ALT,       // Continue with on_alt (e.g. SIM needs the PIN, GPS is off)
+    STEP_RETRY,     // Transient state, repeat the step after the backoff delay
+    STEP_FAIL,      // Continue with on_fail
+    STEP_PENDING,   // The action is still waiting, call it again from the next poll
+} StepResult_t;
+
+// Run-time arguments of a command (index into init.args)
+typedef enum {
+    INIT_ARG_NONE = 0,
+    INIT_ARG_PIN,
+    INIT_ARG_URL,
+} InitArg_t;
+
+// Evaluates the result of a step (response holds the information lines)
+typedef StepResult_t (*init_eval_t)(AtResponseStatus_t resp, const at_resp_t *response, uint8_t debug);
+// Local action instead of a command. Returns 0 on success, -1 on failure, 1 while it is still
+// waiting (it is called again from the next sim7600e_poll(), without a new attempt).
+typedef int (*init_action_t)(uint8_t debug);
 
-    // Check input parameter 
-    if (response_str == NULL) {
-        return CREG_STATE_INVALID;
-    }
+typedef struct {
+    const char *name;           // For debug output
+    Sim7600eBootPhase_t phase;  // The time of the step is accounted to this phase
+    const char *cmd;            // Command, or its prefix if arg is set. NULL: run action instead.
+    InitArg_t arg;              // Run-time argument sent after cmd
+    const char *suffix;         // Sent after the argument
+    init_action_t action;
+    uint32_t timeout_ms;
+    AtResponseStatus_t expect;  // Response for STEP_OK if there is no evaluator (else STEP_RETRY)
+    init_eval_t eval;           // Optional, replaces expect
+    uint8_t attempts;           // Tries before the step fails (bounds the polling)
+    uint32_t backoff_ms;        // Delay before the first retry, doubled for every further retry
+    uint32_t backoff_max_ms;
+    InitStep_t on_ok;
+    InitStep_t on_alt;
+    InitStep_t on_fail;
+} InitStepDesc_t;
+
+static StepResult_t init_eval_cpin(AtResponseStatus_t resp, const at_resp_t *response, uint8_t debug);
+static StepResult_t init_eval_cpin_ready(AtResponseStatus_t resp, const at_resp_t *response, uint8_t debug);
+static StepResult_t init_eval_creg(AtResponseStatus_t resp, const at_resp_t *response, uint8_t debug);
+static StepResult_t init_eval_csq(AtResponseStatus_t resp, const at_resp_t *response, uint8_t debug);
+static StepResult_t init_eval_cgatt(AtResponseStatus_t resp, const at_resp_t *response, uint8_t debug);
+static StepResult_t init_eval_cgact(AtResponseStatus_t resp, const at_resp_t *response, uint8_t debug);
+static StepResult_t init_eval_cgpaddr(AtResponseStatus_t resp, const at_resp_t *response, uint8_t debug);
+static StepResult_t init_eval_cgps(AtResponseStatus_t resp, const at_resp_t *response, uint8_t debug);
+static int init_link_default(uint8_t debug);
+static int init_wait_boot(uint8_t debug);
+static int init_baudrate(uint8_t debug);
+static int http_post_result(const char *line, size_t len);
+
+static const InitStepDesc_t InitSteps[INIT_STEP_COUNT] = {
+    // A silent modem is reset anyway
+    [INIT_SYNC] = {
+        .name = "SYNC", .phase = SIM7600E_PHASE_AT, .action = sim7600e_sync_baudrate, .expect = AT_OK, .attempts = 1,
+        .on_ok = INIT_WARM_CPIN, .on_fail = INIT_RESET,
+    },
+    // Warm start: no retries, every doubt is settled by the reset
+    [INIT_WARM_CPIN] = {
+        .name = "CPIN", .phase = SIM7600E_PHASE_SIM, .cmd = "AT+CPIN?\r", .timeout_ms = 1000, .expect = AT_CPIN_READY, .attempts = 1,
+        .on_ok = INIT_WARM_CREG, .on_fail = INIT_RESET,
+    },
+    [INIT_WARM_CREG] = {
+        .name = "CREG", .phase = SIM7600E_PHASE_CREG, .cmd = "AT+CREG?\r", .timeout_ms = 1000, .eval = init_eval_creg, .attempts = 1,
+        .on_ok = INIT_WARM_CGACT, .on_fail = INIT_RESET,
+    },
+    [INIT_WARM_CGACT] = {
+        .name = "CGACT", .phase = SIM7600E_PHASE_PDP, .cmd = "AT+CGACT?\r", .timeout_ms = 1000, .eval = init_eval_cgact, .attempts = 1,
+        .on_ok = INIT_WARM_CGPADDR, .on_fail = INIT_RESET,
+    },
+    // Healthy: the HTTP service is set up again, the GNSS session is kept by INIT_CGPS_QUERY
+    [INIT_WARM_CGPADDR] = {
+        .name = "CGPADDR", .phase = SIM7600E_PHASE_PDP, .cmd = "AT+CGPADDR=1\r", .timeout_ms = 500, .eval = init_eval_cgpaddr, .attempts = 1,
+        .on_ok = INIT_HTTPTERM, .on_fail = INIT_RESET,
+    },
+    [INIT_RESET] = {
+        .name = "CFUN", .phase = SIM7600E_PHASE_AT, .cmd = "AT+CFUN=1,1\r", .timeout_ms = 500, .expect = AT_OK, .attempts = 1,
+        .on_ok = INIT_LINK_DEFAULT, .on_fail = INIT_ABORT,
+    },
+    // Switched before the boot, so its URCs (RDY, +CPIN: ...) arrive at the right rate
+    [INIT_LINK_DEFAULT] = {
+        .name = "LINK", .phase = SIM7600E_PHASE_AT, .action = init_link_default, .expect = AT_OK, .attempts = 1,
+        .on_ok = INIT_BOOT, .on_fail = INIT_ABORT,
+    },
+    [INIT_BOOT] = {
+        .name = "BOOT", .phase = SIM7600E_PHASE_AT, .action = init_wait_boot, .expect = AT_OK, .attempts = 1,
+        .on_ok = INIT_AT, .on_fail = INIT_ABORT,
+    },
+    [INIT_AT] = {
+        .name = "AT", .phase = SIM7600E_PHASE_AT, .cmd = "AT\r", .timeout_ms = 500, .expect = AT_OK,
+        .attempts = 3, .backoff_ms = 250, .backoff_max_ms = 1000,
+        .on_ok = INIT_BAUDRATE, .on_fail = INIT_ABORT,
+    },
+    // Falls back to the default rate on failure
+    [INIT_BAUDRATE] = {
+        .name = "IPR", .phase = SIM7600E_PHASE_AT, .action = init_baudrate, .expect = AT_OK, .attempts = 1,
+        .on_ok = INIT_CPIN_QUERY, .on_fail = INIT_CPIN_QUERY,
+    },
+    // The SIM may still be busy when the boot is detected by an AT probe
+    [INIT_CPIN_QUERY] = {
+        .name = "CPIN", .phase = SIM7600E_PHASE_SIM, .cmd = "AT+CPIN?\r", .timeout_ms = 1000, .eval = init_eval_cpin,
+        .attempts = 6, .backoff_ms = 500, .backoff_max_ms = 4000,
+        .on_ok = INIT_CREG, .on_alt = INIT_CPIN_UNLOCK, .on_fail = INIT_ABORT,
+    },
+    [INIT_CPIN_UNLOCK] = {
+        .name = "CPIN", .phase = SIM7600E_PHASE_SIM, .cmd = "AT+CPIN=\"", .arg = INIT_ARG_PIN, .suffix = "\"\r",
+        .timeout_ms = 1000, .expect = AT_OK, .attempts = 1,
+        .on_ok = INIT_CPIN_WAIT, .on_fail = INIT_ABORT,
+    },
+    // Never unlocks again: a wrong PIN must not use up the SIM's attempts
+    [INIT_CPIN_WAIT] = {
+        .name = "CPIN", .phase = SIM7600E_PHASE_SIM, .cmd = "AT+CPIN?\r", .timeout_ms = 1000, .eval = init_eval_cpin_ready,
+        .attempts = 8, .backoff_ms = 250, .backoff_max_ms = 2000,
+        .on_ok = INIT_CREG, .on_fail = INIT_ABORT,
+    },
+    // Registration on the CS domain may take a while after the SIM is unlocked
+    [INIT_CREG] = {
+        .name = "CREG", .phase = SIM7600E_PHASE_CREG, .cmd = "AT+CREG?\r", .timeout_ms = 5000, .eval = init_eval_creg,
+        .attempts = 12, .backoff_ms = 250, .backoff_max_ms = 4000,
+        .on_ok = INIT_CSQ, .on_fail = INIT_ABORT,
+    },
+    // RSSI is unknown (99) for a moment after the registration
+    [INIT_CSQ] = {
+        .name = "CSQ", .phase = SIM7600E_PHASE_CSQ, .cmd = "AT+CSQ\r", .timeout_ms = 1000, .eval = init_eval_csq,
+        .attempts = 5, .backoff_ms = 250, .backoff_max_ms = 2000,
+        .on_ok = INIT_CGATT_QUERY, .on_fail = INIT_ABORT,
+    },
+    [INIT_CGATT_QUERY] = {
+        .name = "CGATT", .phase = SIM7600E_PHASE_CGATT, .cmd = "AT+CGATT?\r", .timeout_ms = 1000, .eval = init_eval_cgatt,
+        .attempts = 3, .backoff_ms = 250, .backoff_max_ms = 1000,
+        .on_ok = INIT_CGDCONT_DELETE, .on_alt = INIT_CGATT_ATTACH, .on_fail = INIT_ABORT,
+    },
+    [INIT_CGATT_ATTACH] = {
+        .name = "CGATT", .phase = SIM7600E_PHASE_CGATT, .cmd = "AT+CGATT=1\r", .timeout_ms = 5000, .expect = AT_OK, .attempts = 1,
+        .on_ok = INIT_CGDCONT_DELETE, .on_fail = INIT_ABORT,
+    },
+    // Fails if the context does not exist yet
+    [INIT_CGDCONT_DELETE] = {
+        .name = "CGDCONT", .phase = SIM7600E_PHASE_PDP, .cmd = "AT+CGDCONT=1\r", .timeout_ms = 500, .expect = AT_OK, .attempts = 1,
+        .on_ok = INIT_CGDCONT_SET, .on_fail = INIT_CGDCONT_SET,
+    },
+    // Context ID 1, IP protocol, APN 'internet'
+    [INIT_CGDCONT_SET] = {
+        .name = "CGDCONT", .phase = SIM7600E_PHASE_PDP, .cmd = "AT+CGDCONT=1,\"IP\",\"internet\"\r", .timeout_ms = 500, .expect = AT_OK, .attempts = 1,
+        .on_ok = INIT_CGACT, .on_fail = INIT_ABORT,
+    },
+    [INIT_CGACT] = {
+        .name = "CGACT", .phase = SIM7600E_PHASE_PDP, .cmd = "AT+CGACT=1,1\r", .timeout_ms = 500, .expect = AT_OK, .attempts = 1,
+        .on_ok = INIT_CGPADDR, .on_fail = INIT_ABORT,
+    },
+    // The address may follow the activation with a short delay
+    [INIT_CGPADDR] = {
+        .name = "CGPADDR", .phase = SIM7600E_PHASE_PDP, .cmd = "AT+CGPADDR=1\r", .timeout_ms = 500, .eval = init_eval_cgpaddr,
+        .attempts = 5, .backoff_ms = 250, .backoff_max_ms = 2000,
+        .on_ok = INIT_HTTPTERM, .on_fail = INIT_ABORT,
+    },
+    // Terminate a still active HTTP service, the result does not matter
+    [INIT_HTTPTERM] = {
+        .name = "HTTPTERM", .phase = SIM7600E_PHASE_HTTP, .cmd = "AT+HTTPTERM\r", .timeout_ms = 300, .expect = AT_OK, .attempts = 1,
+        .on_ok = INIT_HTTPINIT, .on_fail = INIT_HTTPINIT,
+    },
+    [INIT_HTTPINIT] = {
+        .name = "HTTPINIT", .phase = SIM7600E_PHASE_HTTP, .cmd = "AT+HTTPINIT\r", .timeout_ms = 500, .expect = AT_OK,
+        .attempts = 3, .backoff_ms = 250, .backoff_max_ms = 1000,
+        .on_ok = INIT_HTTP_CONTENT, .on_fail = INIT_ABORT,
+    },
+    [INIT_HTTP_CONTENT] = {
+        .name = "HTTPPARA", .phase = SIM7600E_PHASE_HTTP, .cmd = "AT+HTTPPARA=\"CONTENT\",\"application/octet-stream\"\r",
+        .timeout_ms = 500, .expect = AT_OK, .attempts = 1,
+        .on_ok = INIT_HTTP_URL, .on_fail = INIT_ABORT,
+    },
+    // Streamed, so the URL length is only limited by the modem
+    [INIT_HTTP_URL] = {
+        .name = "HTTPPARA", .phase = SIM7600E_PHASE_HTTP, .cmd = "AT+HTTPPARA=\"URL\",\"", .arg = INIT_ARG_URL, .suffix = "\"\r",
+        .timeout_ms = 500, .expect = AT_OK, .attempts = 1,
+        .on_ok = INIT_CGPS_QUERY, .on_fail = INIT_ABORT,
+    },
+    [INIT_CGPS_QUERY] = {
+        .name = "CGPS", .phase = SIM7600E_PHASE_GNSS, .cmd = "AT+CGPS?\r", .timeout_ms = 500, .eval = init_eval_cgps,
+        .attempts = 3, .backoff_ms = 250, .backoff_max_ms = 1000,
+        .on_ok = INIT_DONE, .on_alt = INIT_CGPS_ENABLE, .on_fail = INIT_ABORT,
+    },
+    [INIT_CGPS_ENABLE] = {
+        .name = "CGPS", .phase = SIM7600E_PHASE_GNSS, .cmd = "AT+CGPS=1\r", .timeout_ms = 500, .expect = AT_OK, .attempts = 1,
+        .on_ok = INIT_DONE, .on_fail = INIT_ABORT,
+    },
+};
 
+// Phase names of the boot report, in the order of Sim7600eBootPhase_t
+static const char * const BootPhaseNames[SIM7600E_PHASE_COUNT] = {
+    "AT alive", "SIM ready", "CREG", "CSQ", "CGATT", "PDP", "HTTP", "GNSS"
+};
 
-    // Locate the specific information line within the full response
-     const char *info_prefix = "+CREG: ";
-    const char *start_pos = strstr(response_str, info_prefix);
-    if (start_pos == NULL) {
-        return CREG_STATE_INVALID;
-    }
+// Timing of the last bring-up
+static Sim7600eBootReport_t boot_report;
+
+// Step to start the next bring-up with: the failed step, or the beginning after a success
+static InitStep_t init_resume_step = INIT_SYNC;
+
+// URCs reported to the application
+static const struct {
+    const char *prefix;
+    Sim7600eEvent_t event;
+} UrcRoutes[] = {
+    {"RDY",             SIM7600E_EVENT_READY},
+    {"+CPIN: ",         SIM7600E_EVENT_SIM},
+    {"+CGEV: ",         SIM7600E_EVENT_PDP},
+    {"+CGPSINFO: ",     SIM7600E_EVENT_GPS},
+    {"+HTTPACTION: ",   SIM7600E_EVENT_HTTP},
+};
 
-    // Advance the pointer past the prefix to the numbers
-    start_pos += strlen(info_prefix);
+static struct {
+    sim7600e_event_cb_t callback;
+    void *ctx;
+    uint8_t debug;
+    uint8_t up;         // Bring-up finished and no URC reported a loss since
+    uint8_t boot;       // MODEM_BOOT_* URCs seen since the reset
+} modem;
 
-    // Attempt to read the two required integers <n>,<stat>
-    int n = -1;
-    int stat = -1;
+#define MODEM_BOOT_RDY      0x01    // AT interface is up
+#define MODEM_BOOT_PB_DONE  0x02    // SIM and phonebook initialized, the boot is complete
 
-    int scan_count = sscanf(start_pos, "%d,%d", &n, &stat); 
-    
-    if (scan_count != 2) {
-        // Parsing failure (couldn't read two comma-separated integers)
-        return CREG_STATE_INVALID;
-    }
+// Check if a line (not null-terminated) contains word
+static int at_line_contains(const char *line, size_t len, const char *word)
+{
+    size_t n = strlen(word);
 
-    // Map the extracted <stat> value to the CregState_t enum
-    switch (stat) {
-        case 0:
-            return CREG_STATE_NOT_REGISTERED;
-        case 1:
-            return CREG_STATE_HOME_NETWORK;
-        case 2:
-            return CREG_STATE_SEARCHING;
-        case 3:
-            return CREG_STATE_DENIED;
-        case 4:
-            return CREG_STATE_UNKNOWN;
-        case 5:
-            return CREG_STATE_ROAMING;
-        default:
-            // Unrecognized status code
-            return CREG_STATE_INVALID;
+    for (size_t i = 0; i + n <= len; i++) {
+        if (strncmp(&line[i], word, n) == 0) {
+            return 1;
+        }
     }
+    return 0;
 }
 
-// Parse GPS Status response 
-CgpsState_t parse_cgps_status(const char *response_str)
+// The modem lost a state reached by the bring-up: the next bring-up resumes there
+static void sim7600e_lost(InitStep_t step)
 {
-    if (response_str == NULL) {
-        return CGPS_STATE_INVALID;
+    if (modem.up || step < init_resume_step) {
+        init_resume_step = step;
     }
+    modem.up = 0;
+}
 
-    // Handle +CGPS: (GPS Engine Status)
-    const char *info_prefix = "+CGPS: ";
-    const char *start_pos = strstr(response_str, info_prefix);
-
-    
-    if (start_pos != NULL) {
-        // Advance the pointer past the prefix to the numbers
-        start_pos += strlen(info_prefix);
-        
-        int mode = -1;
-        int type = -1;
+// URC handler: track losses of the bring-up state and report the event
+static void sim7600e_urc(const char *line, size_t len, void *ctx)
+{
+    Sim7600eEvent_t event = (Sim7600eEvent_t)(uintptr_t)ctx;
 
-        // Attempt to read the two required integers mode and type.
-        int scan_count = sscanf(start_pos, "%d,%d", &mode, &type); 
+    if (modem.debug) printf("[URC] %.*s\r\n", (int)len, line);
 
-        // Handle GPS OFF state (+CGPS: 0)
-        if (mode == 0) {
-            // The modem might send "+CGPS: 0" (scan_count=1) or "+CGPS: 0,1" (scan_count=2).
-            if (scan_count >= 1) { 
-                return CGPS_STATE_OFF;
+    switch (event) {
+        case SIM7600E_EVENT_READY: {
+            sim7600e_lost(INIT_LINK_DEFAULT);   // Restarted on its own, at the power-up link settings
+        } break;
+        case SIM7600E_EVENT_SIM: {
+            if (parse_at_line(line, len) != AT_CPIN_READY) {
+                sim7600e_lost(INIT_CPIN_QUERY);
             }
-        }
-        
-        // Handle GPS ON states (+CGPS: 1,X)
-        if (mode == 1 && scan_count == 2) {
-            if (type == 1) return CGPS_STATE_ON_STANDALONE;
-            if (type == 2) return CGPS_STATE_ON_AGPS_UE;
-            if (type == 3) return CGPS_STATE_ON_AGPS_ASSIST;
-        }
-
-        // If we found +CGPS: but the parameters were unhandled
-        return CGPS_STATE_INVALID; 
+        } break;
+        case SIM7600E_EVENT_PDP: {
+            // E.g. "+CGEV: NW PDN DEACT 1", "+CGEV: NW DETACH"
+            if (at_line_contains(line, len, "DEACT") || at_line_contains(line, len, "DETACH")) {
+                sim7600e_lost(INIT_CGATT_QUERY);
+            }
+        } break;
+        case SIM7600E_EVENT_HTTP: {
+            if (http_post_result(line, len) == 0) {
+                return;     // Result of the running upload, reported by its callback
+            }
+        } break;
+        default:
+            break;
     }
 
-    // The response string contained do not contain +CGPS:
-    return CGPS_STATE_INVALID;
+    if (modem.callback != NULL) {
+        modem.callback(event, line, len, modem.ctx);
+    }
 }
 
-CgpsState_t parse_cgpsinfo_state(char **response_str)
+// URC handler for the boot indications, see init_wait_boot()
+static void sim7600e_boot_urc(const char *line, size_t len, void *ctx)
 {
+    (void)line;
+    (void)len;
 
-     if (*response_str == NULL) {
-        return CGPS_STATE_INVALID;
-    }
+    modem.boot |= (uint8_t)(uintptr_t)ctx;
+}
 
-    // Handle +CGPSINFO: (Positional Fix Status)
-    const char *info_prefix = "+CGPSINFO: ";
-    char *start_pos  = strstr(*response_str, info_prefix);
+// Set the receiver of unsolicited modem events (called from at_engine_poll())
+void sim7600e_set_event_callback(sim7600e_event_cb_t callback, void *ctx)
+{
+    modem.callback = callback;
+    modem.ctx = ctx;
+}
 
-    if (start_pos != NULL) {
-        
-        // Find the "no fix" pattern first: +CGPSINFO: ,,,,,,,,
-        if (strstr(start_pos, "+CGPSINFO: ,,,,,,,,") != NULL) {
-            return CGPS_STATE_NO_FIX;
-        }
-        
-        // Find the "fix available" pattern
-        char *latitude_start = start_pos + strlen(info_prefix);
-        
-        // Check the character content
-        if (*latitude_start != ',') {
-            // Fix is available.
-            *response_str = latitude_start;   // return the usefull palyoad to the caller
-            return CGPS_STATE_FIX_AVAILABLE;
-        }
-    }
-    
-    // The response string contained do not contain +CGPSINFO:
-    return CGPS_STATE_INVALID;
+// Returns 1 if the bring-up has finished and no URC has reported a loss since.
+// Otherwise the next bring-up resumes with the first lost step.
+int sim7600e_ready(void)
+{
+    return modem.up;
 }
 
-// Parse Signal Quality response
-CsqState_t parse_csq_status(const char *response_str, CsqResult_t *result)
+// After AT+CFUN=1,1 the modem returns to its power-up link settings
+static int init_link_default(uint8_t debug)
 {
-    const char *info_prefix = "+CSQ: ";
-    int raw_rssi = -1;
-    int raw_ber = -1;
-    
-    // Check input parameters
-    if (response_str == NULL || result == NULL) {
-        return CSQ_STATE_INVALID;
-    }
+    (void)debug;
 
-    // Locate the specific information line
-    const char *start_pos = strstr(response_str, info_prefix);
-    if (start_pos == NULL) {
-        return CSQ_STATE_INVALID;
-    }
+    uart_set_flow_control(MODEM_UART, 0);
+    uart_set_baudrate(MODEM_UART, MODEM_DEFAULT_BAUDRATE);
+    at_engine_flush_rx();    // Drop a partial line received at the old rate
+    modem.boot = 0;
 
-    // Advance the pointer past the "+CSQ: " prefix
-    start_pos += strlen(info_prefix);
+    return 0;
+}
 
-    // Attempt to read the two required integers (RSSI and BER)
-    int scan_count = sscanf(start_pos, "%d,%d", &raw_rssi, &raw_ber);
-    if (scan_count != 2) {
-        return CSQ_STATE_INVALID;
+// Boot wait of init_wait_boot(), kept between the polls
+static struct {
+    at_cmd_t probe;         // AT probe, runs on the AT engine
+    uint32_t start;
+    uint32_t probe_at;      // Next probe, relative to start
+    uint32_t backoff_ms;
+    uint8_t rdy;
+    uint8_t waiting;        // Started, no result returned yet
+    uint8_t probing;        // Probe submitted, its result not evaluated yet
+} boot_wait;
+
+static const at_iovec_t boot_probe_cmd[] = { AT_LIT("AT\r") };
+
+// Wait for the modem to boot after AT+CFUN=1,1. The boot is complete with PB DONE. Probes with
+// AT under backoff in case the URCs were missed (at once after RDY). Does not block: returns 1
+// while waiting, 0 when the modem is up, -1 after MODEM_BOOT_TIMEOUT_MS.
+static int init_wait_boot(uint8_t debug)
+{
+    if (!boot_wait.waiting) {
+        boot_wait.start = system_get_tick_ms();
+        boot_wait.probe_at = MODEM_BOOT_PROBE_START_MS;
+        boot_wait.backoff_ms = MODEM_BOOT_PROBE_MIN_MS;
+        boot_wait.rdy = 0;
+        boot_wait.waiting = 1;
+        if (debug) printf("Waiting up to %lu ms for the modem to boot...\r\n", (uint32_t)MODEM_BOOT_TIMEOUT_MS);
     }
-    
-    // Store raw values in the result structure for debugging/logging
-    result->raw_rssi = raw_rssi;
-    result->raw_ber = raw_ber;
 
-    // Map RSSI to the appropriate status
-    if (raw_rssi >= 20 && raw_rssi <= 31) {
-        result->rssi_state = RSSI_STATE_EXCELLENT;
-    }
-    else if (raw_rssi >= 10 && raw_rssi <= 19) {
-        result->rssi_state = RSSI_STATE_GOOD;
-    }
-    else if (raw_rssi >= 2 && raw_rssi <= 9) {
-        result->rssi_state = RSSI_STATE_MARGINAL;
-    }
-    else if (raw_rssi >= 0 && raw_rssi <= 1) {
-        result->rssi_state = RSSI_STATE_MINIMAL;
-    }
-    else if (raw_rssi == 99) {
-        result->rssi_state = RSSI_STATE_UNKNOWN;
-    }
-    else {
-        result->rssi_state = RSSI_STATE_INVALID;
-    }
+    uint32_t elapsed = system_get_tick_ms() - boot_wait.start;
 
-    // 5. Map BER to the appropriate status (using correct logic)
-    if (raw_ber == 0) {
-        result->ber_state = BER_STATE_EXCELLENT;
-    }
-    else if (raw_ber >= 1 && raw_ber <= 2) {
-        result->ber_state = BER_STATE_GOOD;
+    if (boot_wait.probing) {
+        if (boot_wait.probe.state == AT_CMD_PENDING) {
+            return 1;
+        }
+        boot_wait.probing = 0;
+        if (boot_wait.probe.status == AT_OK) {
+            if (debug) printf("Modem booted after %lu ms (AT probe).\r\n", elapsed);
+            boot_wait.waiting = 0;
+            return 0;
+        }
+        boot_wait.probe_at = elapsed + boot_wait.backoff_ms;
+        boot_wait.backoff_ms = (2 * boot_wait.backoff_ms < MODEM_BOOT_PROBE_MAX_MS) ? 2 * boot_wait.backoff_ms : MODEM_BOOT_PROBE_MAX_MS;
     }
-    else if (raw_ber >= 3 && raw_ber <= 4) { // Corrected: 3 and 4
-        result->ber_state = BER_STATE_ACCEPTABLE;
+
+    if (modem.boot & MODEM_BOOT_PB_DONE) {
+        if (debug) printf("Modem booted after %lu ms (PB DONE).\r\n", elapsed);
+        boot_wait.waiting = 0;
+        return 0;
     }
-    else if (raw_ber >= 5 && raw_ber <= 7) { // Corrected: 5, 6, 7
-        result->ber_state = BER_STATE_POOR;
+
+    if (elapsed >= MODEM_BOOT_TIMEOUT_MS) {
+        if (debug) printf("[BOOT] Modem did not boot within %lu ms.\r\n", (uint32_t)MODEM_BOOT_TIMEOUT_MS);
+        boot_wait.waiting = 0;
+        return -1;
     }
-    else if (raw_ber == 99) {
-        result->ber_state = BER_STATE_UNKNOWN;
+
+    if ((modem.boot & MODEM_BOOT_RDY) && !boot_wait.rdy) {
+        boot_wait.rdy = 1;
+        boot_wait.probe_at = elapsed;   // AT interface is up, probe right away
     }
-    else {
-        result->ber_state = BER_STATE_INVALID;
+
+    if (elapsed >= boot_wait.probe_at) {
+        boot_wait.probe.parts = boot_probe_cmd;
+        boot_wait.probe.count = sizeof(boot_probe_cmd) / sizeof(boot_probe_cmd[0]);
+        boot_wait.probe.timeout_ms = 300;
+        boot_wait.probe.wait_for = AT_RX_PARTIAL;
+        boot_wait.probe.resp = NULL;
+        boot_wait.probe.callback = NULL;
+        boot_wait.probe.debug = 0;
+
+        if (at_engine_submit(&boot_wait.probe) == 0) {
+            boot_wait.probing = 1;
+        } else {
+            boot_wait.probe_at = elapsed + boot_wait.backoff_ms;  // Engine busy, try later
+        }
     }
 
-    return CSQ_STATE_OK;
+    return 1;
 }
 
-// Evaluate Sqignal Quality results 
-int sim7600e_eval_sq_result(CsqResult_t *result, uint8_t debug)
+// Speed up the link for the rest of the session (stays at the default rate on failure)
+static int init_baudrate(uint8_t debug)
 {
-    int rv = 0;
+#if MODEM_HIGH_BAUD_ENABLE
+    sim7600e_negotiate_baudrate(MODEM_TARGET_BAUDRATE, debug);
+#else
+    (void)debug;
+#endif
+    return 0;
+}
 
-    // Input parameter check 
-    if (result == NULL) {
-        if (debug) printf ("Error: Signal Quality result is null.\r\n");
-        return --rv;
-    }
+// Unlock the SIM only if it asks for the PIN
+static StepResult_t init_eval_cpin(AtResponseStatus_t resp, const at_resp_t *response, uint8_t debug)
+{
+    (void)response;
 
-    // Evaluate RSSI (Signal Strength)
-    switch (result->rssi_state) {
-        case RSSI_STATE_EXCELLENT:
-        case RSSI_STATE_GOOD: {
-            if (debug) printf("Signal Report: RSSI is %s. (Raw: %d).\r\n", 
-                             RSSI_STATE_STRINGS[result->rssi_state], result->raw_rssi);
-        
-        } break;
-        case RSSI_STATE_UNKNOWN: {
-             if (debug) printf("Error: RSSI is %s (Raw: %d). Cannot establish connection yet. Stopping.\r\n", 
-                             RSSI_STATE_STRINGS[result->rssi_state], result->raw_rssi);
-            return --rv;
+    switch (resp) {
+        case AT_CPIN_READY: {
+            if (debug) printf("SIM already unlocked.\r\n");
+            return STEP_OK;
         }
-        case RSSI_STATE_MARGINAL:
-        case RSSI_STATE_MINIMAL:
-        case RSSI_STATE_INVALID:
-        default: {
-             if (debug) printf("Error: RSSI is %s (Raw: %d). Signal too weak/invalid. Stopping.\r\n", 
-                             RSSI_STATE_STRINGS[result->rssi_state], result->raw_rssi);
-            return --rv;
+        case AT_CPIN_SIM_PIN: {
+            if (debug) printf("Try to unlock SIM\r\n");
+            return STEP_ALT;
+        }
+        case AT_CPIN_SIM_PUK: {
+            if (debug) printf("[CPIN] Error: SIM is PUK-locked. Manual intervention required.\r\n");
+            return STEP_FAIL;
+        }
+        case AT_CME_ERROR:
+        case AT_TIMEOUT: {
+            return STEP_RETRY;  // SIM busy or not answering yet
         }
-    }
-
-    // Evaluate BER (Bit Error Rate)
-    switch (result->ber_state) {
-        case BER_STATE_EXCELLENT:
-        case BER_STATE_GOOD:
-        case BER_STATE_ACCEPTABLE: {
-            if (debug) printf("Signal Report: BER is %s. (Raw: %d). Quality is OK.\r\n",
-                             BER_STATE_STRINGS[result->ber_state], result->raw_ber);
-        } break;
-        case BER_STATE_UNKNOWN: {
-            // BER 99 is common/acceptable on LTE if RSSI is already determined to be good/excellent.
-            if (debug) printf("Signal Report: BER is %s (Raw: %d). Accepted due to strong RSSI.\r\n", 
-                                BER_STATE_STRINGS[result->ber_state], result->raw_ber);
-        } break;
-        case BER_STATE_POOR:
-        case BER_STATE_INVALID:
         default: {
-            if (debug) printf("Error: BER is %s (Raw: %d). Poor quality/invalid value. Stopping.\r\n", 
-                             BER_STATE_STRINGS[result->ber_state], result->raw_ber);
-            return --rv;
+            // Catch-all for NOT INSERTED, etc.
+            if (debug) printf("[CPIN] Error: response not supported or failure (Code: %d).\r\n", resp);
+            return STEP_FAIL;
         }
     }
-
-    if (debug) printf("Signal quality check PASSED. Proceeding...\r\n");
-    return 0; // Success
 }
 
-// Parse Network attachment status 
-CgattState_t parse_cgatt_status(const char *response_str)
+// Wait until the SIM is ready after unlocking
+static StepResult_t init_eval_cpin_ready(AtResponseStatus_t resp, const at_resp_t *response, uint8_t debug)
 {
-    // Input parameter check 
-    if (response_str == NULL) {
-        return CGATT_STATE_INVALID;
+    (void)response;
+
+    if (resp == AT_CPIN_READY) {
+        if (debug) printf("SIM unlocked.\r\n");
+        return STEP_OK;
     }
 
-    const char *info_prefix = "+CGATT: ";
-    int state = -1;
+    if (resp == AT_CPIN_SIM_PIN || resp == AT_CPIN_SIM_PUK) {
+        if (debug) printf("[CPIN] Failed to unlock SIM\r\n");
+        return STEP_FAIL;
+    }
+
+    return STEP_RETRY;  // SIM busy
+}
 
-    // Locate the specific information line
-    const char *start_pos = strstr(response_str, info_prefix);
-    if (start_pos == NULL) {
-        return CGATT_STATE_INVALID;
+// Registered (home or roaming), still searching, or denied
+static StepResult_t init_eval_creg(AtResponseStatus_t resp, const at_resp_t *response, uint8_t debug)
+{
+    if (resp != AT_INFO_CREG) {
+        return STEP_RETRY;  // AT_TIMEOUT, AT_ERROR, etc.
     }
 
-    // Advance the pointer past the "+CGATT: " prefix
-    start_pos += strlen(info_prefix);
+    CregState_t state = parse_creg_status(at_resp_find(response, AT_INFO_CREG));
 
-    // Attempt to read the two required integers <state>
-    int scan_count = sscanf(start_pos, "%d", &state);
-    if (scan_count != 1) {
-        return CGATT_STATE_INVALID;
+    if ((state == CREG_STATE_HOME_NETWORK) || (state == CREG_STATE_ROAMING)) {
+        if (debug) printf("SIM successfully registered on network.\r\n");
+        return STEP_OK;
     }
 
-    // Map <state> to the enum 
-    if (state == 0) {
-        return CGATT_STATE_DETACHED;
-    } else if (state == 1) {
-        return CGATT_STATE_ATTACHED;
-    } else {
-        // Handle unexpected values
-        return CGATT_STATE_INVALID; 
+    if ((state == CREG_STATE_NOT_REGISTERED) || (state == CREG_STATE_SEARCHING)) {
+        if (debug) printf("Network registration in progress (Status: %d).\r\n", state);
+        return STEP_RETRY;
     }
+
+    if (debug) printf("Network registration failed or denied (Status: %d).\r\n", state);
+    return STEP_FAIL;
 }
 
-// Parse IP-Address confirmation 
-CgpaddrState_t parse_cgpaddr_status(const char *response_str, char *ip_addr)
+// Signal quality must be good enough for a data connection
+static StepResult_t init_eval_csq(AtResponseStatus_t resp, const at_resp_t *response, uint8_t debug)
 {
-    // Check input parameters for NULL
-    if (response_str == NULL || ip_addr == NULL) {
-        return CGPADDR_STATE_INVALID;
+    CsqResult_t sq_result;
+    const char *line = at_resp_find(response, AT_INFO_CSQ);
+
+    if (resp != AT_INFO_CSQ) {
+        return STEP_RETRY;  // No answer yet, e.g. while the modem is busy
     }
 
-    const char *info_prefix = "+CGPADDR: ";
-    int cid = -1;
-    
-    // Prevent garbage data if parsing fails
-    ip_addr[0] = '\0'; 
+    if (parse_csq_status(line, &sq_result) != CSQ_STATE_OK) {
+        if (debug) printf("[CSQ] Failed to parse Signal Quality result from response: %s\r\n", (line != NULL) ? line : "");
+        return STEP_FAIL;
+    }
 
-    // Locate the specific information line
-    const char *start_pos = strstr(response_str, info_prefix);
-    if (start_pos == NULL) {
-        // Did not find the informational prefix.
-        return CGPADDR_STATE_INVALID;
+    if (sq_result.rssi_state == RSSI_STATE_UNKNOWN) {
+        return STEP_RETRY;  // Not measured yet
     }
 
-    // Advance the pointer past the "+CGPADDR: " prefix
-    start_pos += strlen(info_prefix);
+    return (sim7600e_eval_sq_result(&sq_result, debug) == 0) ? STEP_OK : STEP_FAIL;
+}
 
-    // Extract the CID and IP-Address appropriately 
-    int scan_count = sscanf(start_pos, "%d,%[0-9.]", &cid, ip_addr);
+// Attach to the PS domain only if detached
+static StepResult_t init_eval_cgatt(AtResponseStatus_t resp, const at_resp_t *response, uint8_t debug)
+{
+    if (resp != AT_INFO_CGATT) {
+        return STEP_FAIL;
+    }
 
-    // We must successfully read the CID and the IP string (2 items)
-    if (scan_count != 2) {
-        printf("Scan count error: %d\r\n", scan_count);
-        return CGPADDR_STATE_INVALID;
+    switch (parse_cgatt_status(at_resp_find(response, AT_INFO_CGATT))) {
+        case CGATT_STATE_ATTACHED: {
+            if (debug) printf("Data Network (PS Domain) is already attached. Proceeding.\r\n");
+            return STEP_OK;
+        }
+        case CGATT_STATE_DETACHED: {
+            if (debug) printf("Data Network (PS Domain) is detached. Attempting to attach...\r\n");
+            return STEP_ALT;
+        }
+        default: {
+            if (debug) printf("[CGATT] Failed to parse CGATT status or received invalid state.\r\n");
+            return STEP_FAIL;
+        }
+    }
+}
+
+// PDP context 1 must be active
+static StepResult_t init_eval_cgact(AtResponseStatus_t resp, const at_resp_t *response, uint8_t debug)
+{
+    if (resp != AT_INFO_CGACT) {
+        return STEP_FAIL;
     }
 
-    // Check if the extracted IP address string is empty ("")
-    if (ip_addr[0] == '\0') {
-        return CGPADDR_STATE_NOT_ACTIVE;
+    // One line per context
+    for (uint8_t i = 0; i < response->count; i++) {
+        if (parse_cgact_status(response->lines[i].text, 1) == 1) {
+            return STEP_OK;
+        }
     }
 
-    return CGPADDR_STATE_OK;    // success 
+    if (debug) printf("PDP context 1 is not active.\r\n");
+    return STEP_FAIL;
 }
 
-int sim7600e_init(const char *pin, const char *url, uint8_t debug)
+// The context must have a non-empty IP address
+static StepResult_t init_eval_cgpaddr(AtResponseStatus_t resp, const at_resp_t *response, uint8_t debug)
 {
-    char cmd[TX_BUF_SIZE];
-    char rx_buf[RX_BUF_SIZE];     
-    AtResponseStatus_t resp;
-    int rv = 0;
+    char ip_addr[IPV6_ADDR_MAX_LEN];
 
-    // Send the software reset command (timeout can be short, e.g., 500ms, as it only needs to process the command)
-    resp = send_at("AT+CFUN=1,1\r", 500, rx_buf, RX_BUF_SIZE, debug);
-    if (resp != AT_OK) {
-        if (debug) printf("[CFUN] Failed to trigger SIM7600E reset. Satus code: %d\r\n", resp);
-        return --rv;
+    if (resp != AT_INFO_CGPADDR) {
+        return STEP_FAIL;
     }
 
-    // Initial delay for the modem to begin the power-up sequence
-    uint16_t delay_s = 40;
-    if (debug) printf("Modem initiated reset. Waiting %d seconds for boot...\r\n", delay_s);
-    systick_delay_ms(delay_s * 1000); // Wait delay_s seconds
+    switch (parse_cgpaddr_status(at_resp_find(response, AT_INFO_CGPADDR), ip_addr)) {
+        case CGPADDR_STATE_OK: {
+            if (debug) printf("Assigned IP-Address: %s.\r\n", ip_addr);
+            return STEP_OK;
+        }
+        case CGPADDR_STATE_NOT_ACTIVE: {
+            if (debug) printf("[CGPADDR] PDP Context 1 defined, but NOT ACTIVE (IP is empty) yet.\r\n");
+            return STEP_RETRY;
+        }
+        default: {
+            if (debug) printf("[CGPADDR] Failed to parse +CGPADDR: response content format.\r\n");
+            return STEP_FAIL;
+        }
+    }
+}
 
-    uart1_flush_rx_buffer();    // Flush the UART1 RX-Buffer 
+// Enable the GPS engine only if it is off
+static StepResult_t init_eval_cgps(AtResponseStatus_t resp, const at_resp_t *response, uint8_t debug)
+{
+    if (resp != AT_INFO_CGPS) {
+        return STEP_FAIL;
+    }
 
-    // Check the communication after reset 
-    resp = send_at("AT\r", 500, rx_buf, RX_BUF_SIZE, debug);
-    if (resp != AT_OK) {
-        if (debug) printf("[AT] Error: Initial communication attempt with SIM7600E failed.\r\n");
-        return --rv;
+    switch (parse_cgps_status(at_resp_find(response, AT_INFO_CGPS))) {
+        case CGPS_STATE_OFF: {
+            if (debug) printf("GPS is OFF, trying to enable...\r\n");
+            return STEP_ALT;
+        }
+        case CGPS_STATE_ON_STANDALONE:
+        case CGPS_STATE_ON_AGPS_UE:
+        case CGPS_STATE_ON_AGPS_ASSIST: {
+            if (debug) printf("GPS engine enabled.\r\n");
+            return STEP_OK;
+        }
+        default: {
+            if (debug) printf("[CGPS] Failed to parse GPS engine status.\r\n");
+            return STEP_FAIL;
+        }
     }
-    systick_delay_ms(1000); // Wait 1 second
+}
 
-    // Unlock SIM if necessary
-    resp = send_at("AT+CPIN?\r", 1000, rx_buf, RX_BUF_SIZE, debug);  // Query SIM-Lock status 
+// Bring-up run by sim7600e_init_start() and advanced by sim7600e_poll(), one attempt per call
+static struct {
+    const char *args[3];        // Run-time arguments, indexed by InitArg_t
+    InitStep_t id;              // Current step
+    uint8_t attempt;            // Attempts of the current step so far
+    uint32_t backoff_ms;        // Pause before the next attempt
+    uint32_t attempt_ms;        // Time of the last attempt
+    uint32_t step_start;
+    uint32_t start;
+    uint8_t running;
+    uint8_t pending;            // The action of the current attempt is still waiting
+    uint8_t debug;
+    at_resp_t response;
+} init;
+
+// Run one attempt of a step. resp receives the status of its command or action.
+static StepResult_t sim7600e_try_step(const InitStepDesc_t *step, AtResponseStatus_t *resp)
+{
+    if (step->cmd == NULL) {
+        init.response.count = 0;
+        int rv = step->action(init.debug);
 
-    if (resp == AT_CPIN_READY) {
-        if (debug) printf("SIM already unlocked.\r\n");
-    } else if (resp == AT_CPIN_SIM_PIN) {
-        if (debug) printf("Try to unlock SIM\r\n");
-        snprintf(cmd, TX_BUF_SIZE, "AT+CPIN=\"%s\"\r", pin);        
-        resp = send_at(cmd, 1000, rx_buf, RX_BUF_SIZE, debug);
-        if (resp != AT_OK) {
-            if (debug) printf("[CPIN] Failed to unlock SIM\r\n");
-            return --rv;
+        if (rv > 0) {
+            return STEP_PENDING;
         }
-    } else if (resp == AT_CPIN_SIM_PUK) {
-        if (debug) printf("[CPIN] Error: SIM is PUK-locked. Manual intervention required.\r\n");
-        return --rv;
+        *resp = (rv == 0) ? AT_OK : AT_ERROR;
     } else {
-        // Catch-all for NOT INSERTED, etc.
-        if (debug) printf("[CPIN] Error: response not supported or failure (Code: %d).\r\n", resp); 
-        return --rv; 
-    }
-    systick_delay_ms(5000);    // Wait 5 seconds to stabilize 
-    uart1_flush_rx_buffer();    // Flush the UART1 RX-Buffer (erase the unsolicited status codes)
-
-    // Register SIM on the Network: CS Domain
-    const uint8_t registration_attempts = 10;
-    uint8_t sim_registered = 0;
-
-    if (debug) printf("Attempting network registration...\r\n");
-
-    const uint32_t INITIAL_CREG_TIMEOUT = 5000; // 5 seconds for the very first check
-    const uint32_t POLLING_CREG_TIMEOUT = 1000; // 1 second for subsequent checks
-    const uint32_t POLLING_INTERVAL = 3000;     // 3 seconds between checks
-
-    for (uint8_t i = 0; i < registration_attempts; i++) {
-
-        // Adaptive Timeout: Use 5s for the first attempt (i=0), 1s thereafter.
-        uint32_t current_timeout_ms = (i == 0) ? INITIAL_CREG_TIMEOUT : POLLING_CREG_TIMEOUT;
-
-        // Check modem's attachment to the Voice and Network domain 
-        resp = send_at("AT+CREG?\r", current_timeout_ms, rx_buf, RX_BUF_SIZE, debug);
-        if (resp == AT_INFO_CREG) {
-            CregState_t state = parse_creg_status(rx_buf);
-
-            // Check for definitive success states (Registered Home or Roaming)
-            if ((state == CREG_STATE_HOME_NETWORK) || (state == CREG_STATE_ROAMING)) {
-                if (debug) printf("SIM successfully registered on network.\r\n");
-                sim_registered = 1;
-                break; // Exit loop on success
-            } 
-            // Check for expected 'In Progress' or Transient states
-            else if ((state == CREG_STATE_NOT_REGISTERED) || (state == CREG_STATE_SEARCHING)) {
-                if (debug) {
-                    printf("Network registration in progress (Status: %d). Waiting...\r\n", state);
-                }
-                // Delay to allow modem time to register
-                systick_delay_ms(POLLING_INTERVAL); 
-            } 
-            else {  // Handle all failure, denied, or unknown states
-                if (debug) {
-                    printf("Network registration failed or denied (Status: %d). Stopping attempts.\r\n", state);
-                }
-                sim_registered = 0;
-                break; // Exit loop on critical state
-            }
-
-        } else {  // Handle all other codes (AT_TIMEOUT, AT_ERROR, etc.)
-            if (debug) printf("Waiting for network registration. Status: %u. Retrying...\r\n", resp);
-            // Delay to allow modem time to register
-            systick_delay_ms(POLLING_INTERVAL); 
-        }
+        const at_iovec_t parts[] = { at_str(step->cmd), at_str(init.args[step->arg]), at_str(step->suffix) };
+        size_t count = (step->arg != INIT_ARG_NONE) ? sizeof(parts) / sizeof(parts[0]) : 1;
+        *resp = send_at_v(parts, count, step->timeout_ms, &init.response, init.debug);
     }
 
-    if (sim_registered == 0) {
-        if (debug) printf("[CREG] Failed to register on network after %u attempts.\r\n", registration_attempts);
-        return --rv;
+    if (step->eval != NULL) {
+        return step->eval(*resp, &init.response, init.debug);
     }
-    systick_delay_ms(1000);     // Wait 1 second
+    return (*resp == step->expect) ? STEP_OK : STEP_RETRY;
+}
 
-    // Query Signal Quality Information: RSSI and BER
-    resp = send_at("AT+CSQ\r", 1000, rx_buf, RX_BUF_SIZE, debug);
+// Advance the bring-up by one attempt, unless it waits for the backoff of a retry or
+// for a pending action
+static void sim7600e_init_poll(void)
+{
+    const InitStepDesc_t *step = &InitSteps[init.id];
+    AtResponseStatus_t resp = AT_INVALID_PARAM;
+    uint8_t debug = init.debug;
 
-    if (resp == AT_INFO_CSQ) {
-        CsqResult_t sq_result;
-        
-        // Parse the response
-        CsqState_t state = parse_csq_status(rx_buf, &sq_result);
-
-        if (state == CSQ_STATE_OK) {
-            // Evaluate the parsed result
-            if (sim7600e_eval_sq_result(&sq_result, debug) != 0) {
-                // Evaluation failed (e.g., RSSI is Marginal or Unknown)
-                if (debug) printf("Signal quality evaluation failed. Aborting initialization.\r\n");
-                return --rv;
-            }
-            // Signal quality passed evaluation. Continue initialization.
-            
+    if (!init.running) {
+        return;
+    }
+    if (init.attempt > 0 && !init.pending && (system_get_tick_ms() - init.attempt_ms) < init.backoff_ms) {
+        return;
+    }
+
+    if (!init.pending) {
+        if (init.attempt == 0) {
+            init.step_start = system_get_tick_ms();
+            init.backoff_ms = step->backoff_ms;
         } else {
-            // Critical: Failed to parse the +CSQ: line structure
-            if (debug) printf("[CSQ] Failed to parse Signal Quality result from response: %s\r\n", rx_buf); 
-            return --rv; // Abort on parsing failure
+            init.backoff_ms = (2 * init.backoff_ms < step->backoff_max_ms) ? 2 * init.backoff_ms : step->backoff_max_ms;
         }
-    } else { 
-        // Handle all other codes (AT_TIMEOUT, AT_ERROR, etc.)
-        if (debug) printf("[CSQ] Failed to query Signal Quality information. Status code: %d.\r\n", resp);
-        return --rv; // Abort on command execution failure
+        init.attempt++;
     }
-    systick_delay_ms(1000);     // Wait 1 second
-
-    // -- Initialize HTTP (Data Attached: PS Domain) --
-    resp = send_at("AT+CGATT?\r", 1000, rx_buf, RX_BUF_SIZE, debug);
 
-    if (resp == AT_INFO_CGATT) {
-        CgattState_t state = parse_cgatt_status(rx_buf);
-        
-        if (state == CGATT_STATE_ATTACHED) {
-            if (debug) printf("Data Network (PS Domain) is already attached. Proceeding.\r\n");
-        
-        } else if (state == CGATT_STATE_DETACHED) {
-            if (debug) printf("Data Network (PS Domain) is detached. Attempting to attach...\r\n");
+    StepResult_t result = sim7600e_try_step(step, &resp);
 
-            // Attempting to attach to PS Domain. Using 5s timeout as attachment may take time.
-            resp = send_at("AT+CGATT=1\r", 5000, rx_buf, RX_BUF_SIZE, debug);
-            
-            if (resp == AT_OK) {
-                if (debug) printf("Data Network attached successfully (AT+CGATT=1). \r\n");
-            } else {
-                if (debug) printf("[CGATT] Failed to attach to PS Domain (AT+CGATT=1). Status code: %d.\r\n", resp);
-                return --rv;
-            }
+    init.pending = (result == STEP_PENDING);
+    if (init.pending) {
+        return;     // Same attempt again from the next call
+    }
+    init.attempt_ms = system_get_tick_ms();
 
-        } else {
-            // Handle parsing failure or an unknown state value
-            if (debug) printf("[CGATT] Failed to parse CGATT status or received invalid state. Status code from Query: %d.\r\n", resp);
-            return --rv;
+    if (result == STEP_RETRY) {
+        if (init.attempt < step->attempts) {
+            if (debug) printf("[%s] Not ready (Status code: %d). Retrying in %lu ms...\r\n", step->name, resp, init.backoff_ms);
+            return;     // Try again from a later call, the main loop keeps running meanwhile
         }
+        if (debug) printf("[%s] Failed after %u attempt(s). Status code: %d.\r\n", step->name, step->attempts, resp);
+        result = STEP_FAIL;
+    }
 
-    } else {
-        // Handle failures of the initial query (AT_TIMEOUT, AT_ERROR, etc.)
-        if (debug) printf("[CGATT] Failed to query Data Network attachment status. Status code: %d.\r\n", resp);
-        return --rv;
+    boot_report.phase_ms[step->phase] += system_get_tick_ms() - init.step_start;
+    boot_report.phase_tries[step->phase] += init.attempt;
+    boot_report.total_ms = system_get_tick_ms() - init.start;
+    init.attempt = 0;
+
+    if (init.id == INIT_RESET) {
+        boot_report.reset = 1;
+    } else if (init.id == INIT_WARM_CGPADDR && result == STEP_OK) {
+        if (debug) printf("Modem is still registered with an active PDP context, skipping the reset.\r\n");
     }
-    systick_delay_ms(1000);     // Wait 1 second
 
-    // -- Data Connection Setup --
-    // Delete the old context for data connection 
-    resp = send_at("AT+CGDCONT=1\r", 500, rx_buf, RX_BUF_SIZE, debug); 
-    
-    if (resp == AT_OK) {
-        if (debug) printf("PDP context 1 deleted successfully.\r\n");
-    } else {
-        // This can fail, as the context might not exist yet. 
-        if (debug) printf("[CGDCONT] Warning: Failed to delete context. Status code: %d. Proceeding...\r\n", resp);
-        // no error return 
+    switch (result) {
+        case STEP_OK: {
+            init.id = step->on_ok;
+        } break;
+        case STEP_ALT: {
+            init.id = step->on_alt;
+        } break;
+        default: {
+            if (step->on_fail == INIT_ABORT) {
+                // Keep the failed step for the next attempt
+                init_resume_step = init.id;
+                init.running = 0;
+                boot_report.failed_phase = step->phase;
+                if (debug) printf("Modem bring-up stopped at step %s.\r\n", step->name);
+                return;
+            }
+            init.id = step->on_fail;    // Non-critical step
+        } break;
     }
 
-    // Define new context for data connection: Context ID 1, IP protocol, APN 'internet'
-    const char *apn_cmd = "AT+CGDCONT=1,\"IP\",\"internet\"\r";
-    resp = send_at(apn_cmd, 500, rx_buf, RX_BUF_SIZE, debug); 
-    
-    if (resp == AT_OK) {
-        if (debug) printf("New context set: %s.\r\n", apn_cmd);
-    } else {
-        if (debug) printf("[CGDCONT] Failed to set context. Command: %s. Status: %d.\r\n", apn_cmd, resp);
-        return --rv;
+    if (init.id >= INIT_STEP_COUNT) {
+        init_resume_step = INIT_SYNC;
+        init.running = 0;
+        modem.up = 1;
+        boot_report.complete = 1;
+        if (debug) printf("Modem up after %lu ms.\r\n", boot_report.total_ms);
     }
+}
 
-    // Activate the new context for data connection 
-    resp = send_at("AT+CGACT=1,1\r", 500, rx_buf, RX_BUF_SIZE, debug);
-    
-    if (resp == AT_OK) {
-        if (debug) printf("New Context was successfully activated.\r\n");
-    } else {
-        if (debug) printf("[CGACT] Failed to activate new context. Status code: %d.\r\n", resp);
-        return --rv;
+// Start bringing the modem up for GPS and HTTP uploads (InitSteps table) in the background:
+// sim7600e_poll() runs the steps, retries wait without blocking. pin and url must stay valid.
+// After a failure the next start resumes with the failed step instead of resetting the modem again.
+// Restarts the AT engine, so no command may be running. Returns 0 if started, -1 if already running.
+int sim7600e_init_start(const char *pin, const char *url, uint8_t debug)
+{
+    if (init.running) {
+        return -1;
+    }
+
+    // All modem traffic runs through the AT engine, unsolicited lines are routed to sim7600e_urc()
+    at_engine_init(MODEM_UART, parse_at_line);
+    for (size_t i = 0; i < sizeof(UrcRoutes) / sizeof(UrcRoutes[0]); i++) {
+        at_engine_register_urc(UrcRoutes[i].prefix, sim7600e_urc, (void *)(uintptr_t)UrcRoutes[i].event);
+    }
+    at_engine_register_urc("RDY", sim7600e_boot_urc, (void *)(uintptr_t)MODEM_BOOT_RDY);
+    at_engine_register_urc("PB DONE", sim7600e_boot_urc, (void *)(uintptr_t)MODEM_BOOT_PB_DONE);
+    modem.debug = debug;
+    modem.up = 0;
+
+    init.args[INIT_ARG_NONE] = NULL;
+    init.args[INIT_ARG_PIN] = pin;
+    init.args[INIT_ARG_URL] = url;
+    init.id = init_resume_step;
+    init.attempt = 0;
+    init.pending = 0;
+    init.start = system_get_tick_ms();
+    init.debug = debug;
+    init.running = 1;
+
+    memset(&boot_report, 0, sizeof(boot_report));
+    boot_report.resumed = (init.id != INIT_SYNC);
+
+    if (debug && init.id != INIT_SYNC) printf("Resuming modem bring-up at step %s.\r\n", InitSteps[init.id].name);
+    return 0;
+}
+
+// Returns 1 while a bring-up started by sim7600e_init_start() is running
+int sim7600e_init_busy(void)
+{
+    return init.running;
+}
+
+// Bring the modem up and wait for the result (see sim7600e_init_start()).
+// Returns 0 on success, -1 on failure.
+int sim7600e_init(const char *pin, const char *url, uint8_t debug)
+{
+    if (sim7600e_init_start(pin, url, debug) != 0) {
+        return -1;
     }
 
-    // Confirm the assigned IP address
-    resp = send_at("AT+CGPADDR=1\r", 500, rx_buf, RX_BUF_SIZE, debug);
+    while (init.running) {
+        at_engine_poll();
+        sim7600e_init_poll();
+    }
 
-    if (resp == AT_INFO_CGPADDR) {
-        // A valid info line was received. Now, check the content.
-        char ip_addr[IPV6_ADDR_MAX_LEN]; 
-        
-        CgpaddrState_t state = parse_cgpaddr_status(rx_buf, ip_addr);
+    return modem.up ? 0 : -1;   // 0 on success
+}
 
-        if (state == CGPADDR_STATE_OK) {
-            // Success: A non-empty IP address was found and copied.
-            if (debug) printf("Assigned IP-Address: %s.\r\n", ip_addr);
+// Print the time each phase of the last bring-up took
+void sim7600e_print_boot_report(void)
+{
+    printf("Modem bring-up: %s after %lu ms (%s%s)\r\n",
+           boot_report.complete ? "done" : "FAILED", boot_report.total_ms,
+           boot_report.reset ? "reset" : "warm", boot_report.resumed ? ", resumed" : "");
 
-        } else if (state == CGPADDR_STATE_NOT_ACTIVE) {
-            // Failure: The context is defined but the IP field was empty ("").
-            if (debug) printf("[CGPADDR] PDP Context 1 defined, but NOT ACTIVE (IP is empty). Cannot proceed to data.\r\n");
-            return --rv;
+    for (size_t i = 0; i < SIM7600E_PHASE_COUNT; i++) {
+        const char *mark = (!boot_report.complete && boot_report.failed_phase == i) ? "  <- failed" : "";
 
-        } else { // CGPADDR_STATE_INVALID
-            // Failure: Parsing failed (malformed response content).
-            if (debug) printf("[CGPADDR] Failed to parse +CGPADDR: response content format.\r\n");
-            return --rv;
-        }
-    } else {
-        // Handle failures of the initial query (AT_TIMEOUT, AT_ERROR, etc.)
-        if (debug) printf("[CGPADDR] Failed to query IP-Address. Status code: %d.\r\n", resp);
-        return --rv;
+        printf("  %-10s %6lu ms  %3u tries%s\r\n", BootPhaseNames[i],
+               boot_report.phase_ms[i], boot_report.phase_tries[i], mark);
     }
-    systick_delay_ms(1000);     // Wait 1 second
+}
 
-    // Attempt to terminate HTTP service first, just in case it's already active.
-    // Ignore the result of TERM, as we just want to ensure it's clean.
-    send_at("AT+HTTPTERM\r", 300, rx_buf, RX_BUF_SIZE, debug); 
+// Background HTTP POST: AT+HTTPDATA -> body -> AT+HTTPACTION=1 -> +HTTPACTION result URC
+typedef enum {
+    HTTP_POST_IDLE = 0,
+    HTTP_POST_DATA,         // Waiting for DOWNLOAD
+    HTTP_POST_BODY,         // Body sent, waiting for OK
+    HTTP_POST_ACTION,       // Waiting for the OK of AT+HTTPACTION
+    HTTP_POST_RESULT,       // Waiting for the URC +HTTPACTION: <method>,<status>,<datalen> (see sim7600e_poll())
+} HttpPostStage_t;
+
+#define HTTP_ACTION_LINE_MAX    48  // "+HTTPACTION: 1,200,4294967295" with room to spare
+
+static struct {
+    at_cmd_t cmd;
+    at_iovec_t parts[3];
+    char len_str[11];
+    at_resp_t resp;
+    const uint8_t *data;
+    size_t len;
+    uint32_t timeout_ms;
+    uint32_t action_ms;     // Time of the AT+HTTPACTION OK, start of the result timeout
+    HttpPostStage_t stage;
+    sim7600e_http_cb_t callback;
+    void *ctx;
+} http_post;
+
+// End the upload and report the result (HTTP status code or negative error)
+static void http_post_finish(int result)
+{
+    http_post.stage = HTTP_POST_IDLE;
+    if (http_post.callback != NULL) {
+        http_post.callback(result, http_post.ctx);
+    }
+}
 
-    // Initialize HTTP (start HTTP service and allocate modem resources)
-    resp = send_at("AT+HTTPINIT\r", 500, rx_buf, RX_BUF_SIZE, debug); 
+// Submit the next request of the upload; its completion calls http_post_step() again
+static void http_post_submit(HttpPostStage_t stage, size_t count, uint32_t timeout_ms)
+{
+    http_post.stage = stage;
+    http_post.cmd.count = count;
+    http_post.cmd.timeout_ms = timeout_ms;
+    http_post.cmd.wait_for = AT_RX_PARTIAL;
+    http_post.cmd.raw = (stage == HTTP_POST_BODY);
 
-    if (resp == AT_OK) {
-        if (debug) printf("HTTP service successfully initialized.\r\n");
-    } else {
-        if (debug) printf("[HTTPINIT] Failed to initialize HTTP service. Status code: %d.\r\n", resp);
-        return --rv;
+    if (at_engine_submit(&http_post.cmd) != 0) {
+        http_post_finish(-1);
     }
+}
 
-    
-    // Set HTTP Content-Type parameter
-    // send_at("AT+HTTPPARA=\"CONTENT\",\"application/octet-stream\"\r", 500, rx_buf, RX_BUF_SIZE, debug);
-    const char *http_ctype_cmd = "AT+HTTPPARA=\"CONTENT\",\"application/octet-stream\"\r";
-    resp = send_at(http_ctype_cmd, 500, rx_buf, RX_BUF_SIZE, debug);
+// Completion callback: evaluate the finished request and start the next one
+static void http_post_step(at_cmd_t *cmd, void *ctx)
+{
+    (void)ctx;
+    uint8_t debug = cmd->debug;
+
+    switch (http_post.stage) {
+        case HTTP_POST_DATA: {
+            if (cmd->status != AT_DOWNLOAD_READY) {
+                if (debug) printf("[HTTPDATA] Modem not ready for the HTTP body. Status code: %d.\r\n", cmd->status);
+                http_post_finish(-2);
+                return;
+            }
 
-    if (resp == AT_OK) {
-        if (debug) printf ("HTTP Content-Type successfully set.\r\n");
-    } else {
-        if (debug) printf ("[HTTPPARA] Failed to set HTTP Content-Type. Status Code: %d.\r\n", resp);
-        return --rv;
-    }
+            // Send the body as is; OK follows once all bytes have arrived
+            http_post.parts[0].base = (const char *)http_post.data;
+            http_post.parts[0].len = http_post.len;
+            http_post_submit(HTTP_POST_BODY, 1, 2000);
+        } break;
+        case HTTP_POST_BODY: {
+            if (cmd->status != AT_OK) {
+                if (debug) printf("[HTTPDATA] HTTP body not accepted. Status code: %d.\r\n", cmd->status);
+                http_post_finish(-3);
+                return;
+            }
 
-    // Set HTTP URL parameter
-    char http_url_cmd[HTTP_URL_MAX_LEN]; 
-    int chars_written = snprintf(
-    http_url_cmd,
-    HTTP_URL_MAX_LEN,
-    "AT+HTTPPARA=\"URL\",\"%s\"\r",
-    url
-    );
+            // Start the POST request (method 1)
+            http_post.parts[0] = (at_iovec_t)AT_LIT("AT+HTTPACTION=1\r");
+            http_post_submit(HTTP_POST_ACTION, 1, 1000);
+        } break;
+        case HTTP_POST_ACTION: {
+            if (cmd->status != AT_OK) {
+                if (debug) printf("[HTTPACTION] Failed to start HTTP POST. Status code: %d.\r\n", cmd->status);
+                http_post_finish(-4);
+                return;
+            }
 
-    // Check for truncation error
-    if (chars_written < 0 || chars_written >= HTTP_URL_MAX_LEN) {
-        if (debug) printf ("[HTTPPARA] The URL command string was too long or invalid.\r\n");
-        return --rv;
+            // The result follows as URC once the server has answered. No command waits for it,
+            // the engine stays free for other requests (sim7600e_poll() checks the timeout).
+            http_post.stage = HTTP_POST_RESULT;
+            http_post.action_ms = system_get_tick_ms();
+        } break;
+        default:
+            break;
     }
+}
 
-    // Send the command
-    resp = send_at(http_url_cmd, 500, rx_buf, RX_BUF_SIZE, debug);
+// Complete the running upload with a +HTTPACTION URC (line not null-terminated).
+// Returns 0 if the line was consumed, -1 if no upload waits for a result.
+static int http_post_result(const char *line, size_t len)
+{
+    char buf[HTTP_ACTION_LINE_MAX];
+    uint8_t debug = http_post.cmd.debug;
+    at_tok_t tok;
+    int method = -1;
+    int status = -1;
+    int datalen = -1;
 
-    if (resp == AT_OK) {
-        if (debug) printf ("HTTP URL parameter successfully set.\r\n");
-    } else {
-        if (debug) printf("[HTTPPARA] Failed to set HTTP URL parameter. Status code: %d.\r\n", resp);
-        return --rv;
+    if (http_post.stage != HTTP_POST_RESULT) {
+        return -1;
+    }
+
+    if (len >= sizeof(buf)) {
+        len = sizeof(buf) - 1;  // Cannot be a valid result, fails below
     }
-    systick_delay_ms(1000);     // Wait 1 second
+    memcpy(buf, line, len);
+    buf[len] = '\0';
 
-    // -- Initialize GPS module -- 
-    resp = send_at("AT+CGPS?\r", 500, rx_buf, RX_BUF_SIZE, debug); // Query GPS engine status
+    if (at_tok_start(&tok, buf, "+HTTPACTION: ") != 0 || at_tok_int(&tok, &method) != 0 ||
+        at_tok_int(&tok, &status) != 0 || at_tok_int(&tok, &datalen) != 0) {
+        if (debug) printf("[HTTPACTION] Failed to parse result: %s\r\n", buf);
+        http_post_finish(-6);
+        return 0;
+    }
 
-    if (resp == AT_INFO_CGPS) {
-        CgpsState_t state = parse_cgps_status(rx_buf);
+    if (debug) printf("HTTP POST of %zu bytes finished with status %d (%d bytes response).\r\n", http_post.len, status, datalen);
+    http_post_finish(status);
+    return 0;
+}
 
-        if (state == CGPS_STATE_OFF) {
-            if (debug) printf("GPS is OFF, trying to enable...\r\n");
-            resp = send_at("AT+CGPS=1\r", 500, rx_buf, RX_BUF_SIZE, debug);
-            if (resp == AT_OK) {
-                if (debug) printf("GPS engine enabled.\r\n");
-            } else {
-                if (debug) printf ("Failed to enable GPS.\r\n");
-                return --rv;
-            }
-        } else if ((state == CGPS_STATE_ON_STANDALONE)  ||
-                (state == CGPS_STATE_ON_AGPS_UE)        ||
-                (state == CGPS_STATE_ON_AGPS_ASSIST)) {
+// Run the background parts of the driver (bring-up steps, upload timeout); call it from the main loop.
+// Does not wait for retries or the modem boot, but a running command step blocks until it is answered.
+void sim7600e_poll(void)
+{
+    sim7600e_init_poll();
 
-            if (debug) printf("GPS engine enabled.\r\n");       
-        }
-    } else { 
-        printf("Failed to query GPS engine status. Status Code: %d.\r\n", resp);
-        return --rv;
+    // The +HTTPACTION URC did not arrive in time
+    if (http_post.stage == HTTP_POST_RESULT &&
+        (system_get_tick_ms() - http_post.action_ms) >= http_post.timeout_ms) {
+        if (http_post.cmd.debug) printf("[HTTPACTION] No result within %lu ms.\r\n", http_post.timeout_ms);
+        http_post_finish(-5);
     }
-
-    return rv;   // 0 on success 
 }
 
-// Get GPS info and save it into the given buffer 
-int sim7600e_get_gps_fix(char **buf, size_t len, uint32_t delay_ms, uint32_t timeout_ms, uint8_t debug)
+// Start uploading data with HTTP POST to the URL configured by sim7600e_init(). Returns immediately;
+// the callback receives the HTTP status code (e.g. 200) or a negative value on failure.
+// data must stay valid until then. Returns 0 if the upload was started, -1 if busy or invalid.
+int sim7600e_http_post_async(const uint8_t *data, size_t len, uint32_t timeout_ms,
+                             sim7600e_http_cb_t callback, void *ctx, uint8_t debug)
 {
     // Input parameter check
-    if (*buf == NULL || len == 0) {
-        return -1; 
+    if (data == NULL || len == 0 || http_post.stage != HTTP_POST_IDLE) {
+        return -1;
     }
 
-    // Clear the buffer
-    *buf[0] = '\0'; 
+    http_post.data = data;
+    http_post.len = len;
+    http_post.timeout_ms = timeout_ms;
+    http_post.callback = callback;
+    http_post.ctx = ctx;
 
-    AtResponseStatus_t resp;
-    uint32_t start_time = system_get_tick_ms();
+    http_post.cmd.parts = http_post.parts;
+    http_post.cmd.resp = &http_post.resp;
+    http_post.cmd.callback = http_post_step;
+    http_post.cmd.ctx = NULL;
+    http_post.cmd.debug = debug;
 
-    // Loop as long as the time elapsed is smaller than given timeout 
-    while ((system_get_tick_ms() - start_time) < timeout_ms) {
+    // Announce the body; the modem answers DOWNLOAD when it is ready to receive it
+    http_post.parts[0] = (at_iovec_t)AT_LIT("AT+HTTPDATA=");
+    http_post.parts[1] = at_str(at_u32_to_str(http_post.len_str, (uint32_t)len));
+    http_post.parts[2] = (at_iovec_t)AT_LIT("," HTTP_DATA_TIMEOUT "\r");
+    http_post_submit(HTTP_POST_DATA, 3, 1000);
 
-        // Send AT command to get GPS info 
-        resp = send_at("AT+CGPSINFO\r", 1000, *buf, len, debug); 
+    return (http_post.stage != HTTP_POST_IDLE) ? 0 : -1;
+}
 
-        if (resp == AT_INFO_CGPSINFO) {
+// Background AT+CGPSINFO query
+static struct {
+    at_cmd_t cmd;
+    at_resp_t resp;
+    sim7600e_gps_cb_t callback;
+    void *ctx;
+} gps_poll;
 
-            // Parse the GPS info
-            CgpsState_t state = parse_cgpsinfo_state(buf);
+static const at_iovec_t cgpsinfo_cmd[] = { AT_LIT("AT+CGPSINFO\r") };
 
-            if (state == CGPS_STATE_FIX_AVAILABLE) {
-                return 0;   // Success, fix was found 
-            } else if (state == CGPS_STATE_NO_FIX) {
-                if (debug) printf("No GPS fix available, continue trying...\r\n");
-                systick_delay_ms(delay_ms);  // wait delay_ms before trying again 
-                continue;
-            } else {
-                // Handle error like INVALIDE_STATE etc.
-                if (debug) printf("Failed to retrieve GPS-Info. Status code: %d.\r\n", resp);
-                return -2; 
-            }
-        } else {
-            // Handle failures of the initial query (AT_TIMEOUT, AT_ERROR, etc.)
-            if (debug) printf("Failed to query GPS info. Status code: %d", resp);
-            return -1;
-        }
-       
+// Completion callback of AT+CGPSINFO
+static void gps_poll_done(at_cmd_t *cmd, void *ctx)
+{
+    (void)ctx;
+
+    if (cmd->status == AT_INFO_CGPSINFO) {
+        const char *info = at_resp_find(&gps_poll.resp, AT_INFO_CGPSINFO);
+        CgpsState_t state = parse_cgpsinfo_state(&info);
+
+        gps_poll.callback(state, (state == CGPS_STATE_FIX_AVAILABLE) ? info : NULL, gps_poll.ctx);
+    } else {
+        if (cmd->debug) printf("Failed to query GPS info. Status code: %d\r\n", cmd->status);
+        gps_poll.callback(CGPS_STATE_INVALID, NULL, gps_poll.ctx);
     }
+}
 
-    return -3; // Error doe to timeout
-}
\ No newline at end of file
+// Start a single GPS position query. Returns immediately; the callback receives the fix state
+// and, if a fix is available, the +CGPSINFO payload (valid during the callback only).
+// Returns 0 if the query was started, -1 if the previous one is still running.
+int sim7600e_gps_poll_async(sim7600e_gps_cb_t callback, void *ctx, uint8_t debug)
+{
+    if (callback == NULL || gps_poll.cmd.state == AT_CMD_PENDING) {
+        return -1;
+    }
+
+    gps_poll.callback = callback;
+    gps_poll.ctx = ctx;
+    gps_poll.cmd.parts = cgpsinfo_cmd;
+    gps_poll.cmd.count = sizeof(cgpsinfo_cmd) / sizeof(cgpsinfo_cmd[0]);
+    gps_poll.cmd.timeout_ms = 1000;
+    gps_poll.cmd.wait_for = AT_RX_PARTIAL;
+    gps_poll.cmd.resp = &gps_poll.resp;
+    gps_poll.cmd.callback = gps_poll_done;
+    gps_poll.cmd.debug = debug;
+
+    return at_engine_submit(&gps_poll.cmd);
+}
@@ -0,0 +1,234 @@
+#include "sim7600e.h"
+#include "at_tok.h"
+
+#include <string.h>
+
+// Parsers of the modem's information lines. Kept free of hardware dependencies,
+// so the host benchmarks (make host-test) build them as they are.
+
+// Parse Network Registration Status response 
+CregState_t parse_creg_status(const char *response_str) {
+    at_tok_t tok;
+    int n = -1;
+    int stat = -1;
+
+    // Locate the specific information line and read the two required integers <n>,<stat>
+    if (at_tok_start(&tok, response_str, "+CREG: ") != 0 ||
+        at_tok_int(&tok, &n) != 0 || at_tok_int(&tok, &stat) != 0) {
+        return CREG_STATE_INVALID;
+    }
+
+    // Map the extracted <stat> value to the CregState_t enum
+    switch (stat) {
+        case 0:
+            return CREG_STATE_NOT_REGISTERED;
+        case 1:
+            return CREG_STATE_HOME_NETWORK;
+        case 2:
+            return CREG_STATE_SEARCHING;
+        case 3:
+            return CREG_STATE_DENIED;
+        case 4:
+            return CREG_STATE_UNKNOWN;
+        case 5:
+            return CREG_STATE_ROAMING;
+        default:
+            // Unrecognized status code
+            return CREG_STATE_INVALID;
+    }
+}
+
+// Parse GPS Status response 
+CgpsState_t parse_cgps_status(const char *response_str)
+{
+    at_tok_t tok;
+    int mode = -1;
+    int type = -1;
+
+    // Handle +CGPS: (GPS Engine Status)
+    if (at_tok_start(&tok, response_str, "+CGPS: ") != 0 || at_tok_int(&tok, &mode) != 0) {
+        return CGPS_STATE_INVALID;
+    }
+
+    // Handle GPS OFF state: the modem might send "+CGPS: 0" or "+CGPS: 0,1"
+    if (mode == 0) {
+        return CGPS_STATE_OFF;
+    }
+
+    // Handle GPS ON states (+CGPS: 1,X)
+    if (mode == 1 && at_tok_int(&tok, &type) == 0) {
+        if (type == 1) return CGPS_STATE_ON_STANDALONE;
+        if (type == 2) return CGPS_STATE_ON_AGPS_UE;
+        if (type == 3) return CGPS_STATE_ON_AGPS_ASSIST;
+    }
+
+    // Found +CGPS: but the parameters were unhandled
+    return CGPS_STATE_INVALID;
+}
+
+CgpsState_t parse_cgpsinfo_state(const char **response_str)
+{
+
+     if (*response_str == NULL) {
+        return CGPS_STATE_INVALID;
+    }
+
+    // Handle +CGPSINFO: (Positional Fix Status)
+    const char *info_prefix = "+CGPSINFO: ";
+    const char *start_pos  = strstr(*response_str, info_prefix);
+
+    if (start_pos != NULL) {
+        
+        // Find the "no fix" pattern first: +CGPSINFO: ,,,,,,,,
+        if (strstr(start_pos, "+CGPSINFO: ,,,,,,,,") != NULL) {
+            return CGPS_STATE_NO_FIX;
+        }
+        
+        // Find the "fix available" pattern
+        const char *latitude_start = start_pos + strlen(info_prefix);
+        
+        // Check the character content
+        if (*latitude_start != ',') {
+            // Fix is available.
+            *response_str = latitude_start;   // return the usefull palyoad to the caller
+            return CGPS_STATE_FIX_AVAILABLE;
+        }
+    }
+    
+    // The response string contained do not contain +CGPSINFO:
+    return CGPS_STATE_INVALID;
+}
+
+// Parse Signal Quality response
+CsqState_t parse_csq_status(const char *response_str, CsqResult_t *result)
+{
+    at_tok_t tok;
+    int raw_rssi = -1;
+    int raw_ber = -1;
+    
+    // Check input parameters
+    if (result == NULL) {
+        return CSQ_STATE_INVALID;
+    }
+
+    // Locate the specific information line and read the two required integers (RSSI and BER)
+    if (at_tok_start(&tok, response_str, "+CSQ: ") != 0 ||
+        at_tok_int(&tok, &raw_rssi) != 0 || at_tok_int(&tok, &raw_ber) != 0) {
+        return CSQ_STATE_INVALID;
+    }
+    
+    // Store raw values in the result structure for debugging/logging
+    result->raw_rssi = raw_rssi;
+    result->raw_ber = raw_ber;
+
+    // Map RSSI to the appropriate status
+    if (raw_rssi >= 20 && raw_rssi <= 31) {
+        result->rssi_state = RSSI_STATE_EXCELLENT;
+    }
+    else if (raw_rssi >= 10 && raw_rssi <= 19) {
+        result->rssi_state = RSSI_STATE_GOOD;
+    }
+    else if (raw_rssi >= 2 && raw_rssi <= 9) {
+        result->rssi_state = RSSI_STATE_MARGINAL;
+    }
+    else if (raw_rssi >= 0 && raw_rssi <= 1) {
+        result->rssi_state = RSSI_STATE_MINIMAL;
+    }
+    else if (raw_rssi == 99) {
+        result->rssi_state = RSSI_STATE_UNKNOWN;
+    }
+    else {
+        result->rssi_state = RSSI_STATE_INVALID;
+    }
+
+    // 5. Map BER to the appropriate status (using correct logic)
+    if (raw_ber == 0) {
+        result->ber_state = BER_STATE_EXCELLENT;
+    }
+    else if (raw_ber >= 1 && raw_ber <= 2) {
+        result->ber_state = BER_STATE_GOOD;
+    }
+    else if (raw_ber >= 3 && raw_ber <= 4) { // Corrected: 3 and 4
+        result->ber_state = BER_STATE_ACCEPTABLE;
+    }
+    else if (raw_ber >= 5 && raw_ber <= 7) { // Corrected: 5, 6, 7
+        result->ber_state = BER_STATE_POOR;
+    }
+    else if (raw_ber == 99) {
+        result->ber_state = BER_STATE_UNKNOWN;
+    }
+    else {
+        result->ber_state = BER_STATE_INVALID;
+    }
+
+    return CSQ_STATE_OK;
+}
+
+// Parse Network attachment status 
+CgattState_t parse_cgatt_status(const char *response_str)
+{
+    at_tok_t tok;
+    int state = -1;
+
+    // Locate the specific information line and read the required integer <state>
+    if (at_tok_start(&tok, response_str, "+CGATT: ") != 0 || at_tok_int(&tok, &state) != 0) {
+        return CGATT_STATE_INVALID;
+    }
+
+    // Map <state> to the enum 
+    if (state == 0) {
+        return CGATT_STATE_DETACHED;
+    } else if (state == 1) {
+        return CGATT_STATE_ATTACHED;
+    } else {
+        // Handle unexpected values
+        return CGATT_STATE_INVALID; 
+    }
+}
+
+// Parse IP-Address confirmation. ip_addr needs IPV6_ADDR_MAX_LEN bytes.
+CgpaddrState_t parse_cgpaddr_status(const char *response_str, char *ip_addr)
+{
+    at_tok_t tok;
+    int cid = -1;
+
+    // Check input parameters for NULL
+    if (ip_addr == NULL) {
+        return CGPADDR_STATE_INVALID;
+    }
+
+    // Prevent garbage data if parsing fails
+    ip_addr[0] = '\0'; 
+
+    // Extract the CID and IP-Address (IPv4, quoted or not)
+    if (at_tok_start(&tok, response_str, "+CGPADDR: ") != 0 || at_tok_int(&tok, &cid) != 0 ||
+        at_tok_ipv4(&tok, ip_addr, IPV6_ADDR_MAX_LEN) < 0) {
+        return CGPADDR_STATE_INVALID;
+    }
+
+    // An empty address (or 0.0.0.0) means the context is not active
+    if (ip_addr[0] == '\0' || strcmp(ip_addr, "0.0.0.0") == 0) {
+        return CGPADDR_STATE_NOT_ACTIVE;
+    }
+
+    return CGPADDR_STATE_OK;    // success 
+}
+
+// Parse the PDP context states (one "+CGACT: <cid>,<state>" line per context).
+// Returns the state of context cid (0: inactive, 1: active) or -1 if it is not listed.
+int parse_cgact_status(const char *response_str, int cid)
+{
+    at_tok_t tok;
+
+    // Check every line of the response
+    for (int rv = at_tok_start(&tok, response_str, "+CGACT: "); rv == 0; rv = at_tok_start(&tok, tok.end, "+CGACT: ")) {
+        int line_cid = -1;
+        int state = -1;
+
+        if (at_tok_int(&tok, &line_cid) == 0 && at_tok_int(&tok, &state) == 0 && line_cid == cid) {
+            return (state == 0 || state == 1) ? state : -1;
+        }
+    }
+
+    return -1;
+}
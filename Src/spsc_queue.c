@@ -0,0 +1,162 @@
+#include "spsc_queue.h"
+
+#include <string.h>
+
+// Order the data accesses against the index update that publishes them.
+// On the Cortex-M4 this emits a DMB, which also orders the accesses against DMA.
+#define SPSC_RELEASE()  __atomic_thread_fence(__ATOMIC_RELEASE)
+#define SPSC_ACQUIRE()  __atomic_thread_fence(__ATOMIC_ACQUIRE)
+
+// Initialize an empty queue on top of buf. size must be a power of two.
+// Returns 0 on success, -1 on invalid parameters.
+int spsc_queue_init(spsc_queue_t *q, uint8_t *buf, uint32_t size)
+{
+    // Input parameter check
+    if (q == NULL || buf == NULL || size < 2U || (size & (size - 1U)) != 0U) {
+        return -1;
+    }
+
+    q->buf = buf;
+    q->size = size;
+    q->mask = size - 1U;
+    q->head = 0;
+    q->tail = 0;
+
+    return 0;
+}
+
+// Append one byte. Returns 0 on success, -1 if the queue is full.
+int spsc_queue_push(spsc_queue_t *q, uint8_t byte)
+{
+    uint32_t head = q->head;
+
+    if ((head - q->tail) == q->size) {
+        return -1;  // Full
+    }
+
+    q->buf[head & q->mask] = byte;
+    SPSC_RELEASE();
+    q->head = head + 1U;
+
+    return 0;
+}
+
+// Append up to len bytes (as many as fit) with at most two copies.
+// Returns the number of bytes queued.
+uint32_t spsc_queue_push_n(spsc_queue_t *q, const uint8_t *data, uint32_t len)
+{
+    uint32_t head = q->head;
+    uint32_t space = q->size - (head - q->tail);
+
+    if (len > space) {
+        len = space;
+    }
+
+    // First chunk up to the end of the storage, second chunk from its start
+    uint32_t offset = head & q->mask;
+    uint32_t first = q->size - offset;
+    if (first > len) {
+        first = len;
+    }
+
+    memcpy(&q->buf[offset], data, first);
+    memcpy(q->buf, &data[first], len - first);
+
+    SPSC_RELEASE();
+    q->head = head + len;
+
+    return len;
+}
+
+// Contiguous free span at the write position, for producers that fill the storage directly
+// (e.g. DMA). Returns the span length; the data becomes visible with spsc_queue_commit_write().
+uint32_t spsc_queue_peek_write(spsc_queue_t *q, uint8_t **span)
+{
+    uint32_t head = q->head;
+    uint32_t space = q->size - (head - q->tail);
+    uint32_t offset = head & q->mask;
+    uint32_t contiguous = q->size - offset;
+
+    *span = &q->buf[offset];
+    return (space < contiguous) ? space : contiguous;
+}
+
+// Publish len bytes written into the storage at the write position
+void spsc_queue_commit_write(spsc_queue_t *q, uint32_t len)
+{
+    SPSC_RELEASE();
+    q->head += len;
+}
+
+// Remove one byte. Returns 0 on success, -1 if the queue is empty.
+int spsc_queue_pop(spsc_queue_t *q, uint8_t *byte)
+{
+    uint32_t tail = q->tail;
+
+    if (q->head == tail) {
+        return -1;  // Empty
+    }
+
+    SPSC_ACQUIRE();
+    *byte = q->buf[tail & q->mask];
+    SPSC_RELEASE();
+    q->tail = tail + 1U;
+
+    return 0;
+}
+
+// Remove up to len bytes (as many as available) with at most two copies.
+// Returns the number of bytes copied.
+uint32_t spsc_queue_pop_n(spsc_queue_t *q, uint8_t *data, uint32_t len)
+{
+    uint32_t tail = q->tail;
+    uint32_t count = q->head - tail;
+
+    if (len > count) {
+        len = count;
+    }
+
+    SPSC_ACQUIRE();
+
+    // First chunk up to the end of the storage, second chunk from its start
+    uint32_t offset = tail & q->mask;
+    uint32_t first = q->size - offset;
+    if (first > len) {
+        first = len;
+    }
+
+    memcpy(data, &q->buf[offset], first);
+    memcpy(&data[first], q->buf, len - first);
+
+    SPSC_RELEASE();
+    q->tail = tail + len;
+
+    return len;
+}
+
+// Contiguous readable span at the read position, for consumers that work in place
+// (e.g. DMA, parsers). Returns the span length; release it with spsc_queue_commit_read().
+uint32_t spsc_queue_peek_read(spsc_queue_t *q, const uint8_t **span)
+{
+    uint32_t tail = q->tail;
+    uint32_t count = q->head - tail;
+    uint32_t offset = tail & q->mask;
+    uint32_t contiguous = q->size - offset;
+
+    SPSC_ACQUIRE();
+    *span = &q->buf[offset];
+    return (count < contiguous) ? count : contiguous;
+}
+
+// Release len bytes at the read position
+void spsc_queue_commit_read(spsc_queue_t *q, uint32_t len)
+{
+    SPSC_RELEASE();
+    q->tail += len;
+}
+
+// Drop everything currently queued (consumer side)
+void spsc_queue_discard(spsc_queue_t *q)
+{
+    q->tail = q->head;
+}
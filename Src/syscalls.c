@@ -45,8 +45,9 @@ caddr_t _sbrk(ptrdiff_t increment) {
 
 // =================== Write ===================
 // _write_r is used by printf and other output functions (stdout/stderr).
-// This implementation is **blocking**: uart2_write() waits until
-// the UART transmit register is ready for each character.
+// This implementation is **non-blocking**: uart_write() queues the
+// bytes in the DBG_UART TX ring buffer and returns, DMA sends them in the background.
+// It only waits if the ring buffer is full and the TX policy is UART_TX_POLICY_BLOCK.
 // Sends `len` bytes from `ptr` to UART.
 __attribute__((used))
 _ssize_t _write_r(struct _reent *r, int file, const void *ptr, size_t len)
@@ -54,18 +55,14 @@ _ssize_t _write_r(struct _reent *r, int file, const void *ptr, size_t len)
     (void)r;
     (void)file;  // stdout/stderr typically
 
-    const char *cptr = ptr;
-    for (size_t i = 0; i < len; i++)
-        uart2_write(*cptr++);  // Blocking: waits if TX register is not ready
-    return len;  // Number of characters actually written
+    return uart_write(DBG_UART, ptr, len);  // Number of characters actually queued
 }
 
 // =================== Read ===================
 // _read_r is used by input functions (scanf, getchar, etc.).
-// This implementation is **blocking** and waits for characters
-// from UART one by one until either:
-//   - a newline ('\n') or carriage return ('\r') is received, OR
-//   - the buffer limit (len) is reached.
+// This implementation is **non-blocking**: it returns the characters already
+// received on DBG_UART, up to and including the first newline ('\n'),
+// or 0 (EOF) if none are buffered. Interactive input is handled by the console (console.c).
 // Returns the number of characters read.
 __attribute__((used))
 _ssize_t _read_r(struct _reent *r, int file, char *ptr, size_t len)
@@ -74,22 +71,26 @@ _ssize_t _read_r(struct _reent *r, int file, char *ptr, size_t len)
     (void)file;
 
     size_t i = 0;
-    while ( i < len) {
-       char ch = uart2_read();
+    while (i < len) {
+        int rx = uart_read_nb(DBG_UART);
+        if (rx < 0) {
+            break;  // Nothing (more) buffered, never wait
+        }
+        char ch = (char)rx;
 
-       // Convert CR to LF
-       if (ch == '\r') {
+        // Convert CR to LF
+        if (ch == '\r') {
             ch = '\n';
         }
 
-       ptr[i++] = ch;
+        ptr[i++] = ch;
 
         if (ch == '\n') {   // only need to check for LF now
             break;  // line based read
         }
     }
 
-   return i;
+    return i;
 }
 
 // =================== File operations ===================
@@ -157,6 +158,7 @@ int _kill(int pid, int sig) {
 void _exit(int status)
 {
     (void)status;
+    uart_flush_tx(DBG_UART, UART_FLUSH_TIMEOUT_MS);  // Let the queued debug output drain
     while (1) {
         // Optionally, trigger a system reset here:
         // NVIC_SystemReset();
@@ -0,0 +1,63 @@
+#include "track_buffer.h"
+
+#include <stddef.h>
+
+
+// Initialize an empty ring on the given storage of capacity points
+void track_buffer_init(track_buffer_t *tb, gps_data_t *storage, uint16_t capacity, track_policy_t policy)
+{
+    tb->points = storage;
+    tb->capacity = capacity;
+    tb->head = 0;
+    tb->count = 0;
+    tb->policy = policy;
+    tb->oldest_seq = 0;
+    tb->overwritten = 0;
+    tb->rejected = 0;
+}
+
+// Append a point. Returns 0 on success (possibly replacing the oldest point),
+// -1 if the ring is full and the policy is TRACK_STOP_WHEN_FULL.
+int track_buffer_push(track_buffer_t *tb, const gps_data_t *point)
+{
+    if (tb->capacity == 0) {
+        return -1;
+    }
+
+    if (tb->count == tb->capacity) {
+        if (tb->policy == TRACK_STOP_WHEN_FULL) {
+            tb->rejected++;
+            return -1;
+        }
+
+        // Drop the oldest point
+        tb->head = (uint16_t)((tb->head + 1) % tb->capacity);
+        tb->count--;
+        tb->oldest_seq++;
+        tb->overwritten++;
+    }
+
+    tb->points[(tb->head + tb->count) % tb->capacity] = *point;
+    tb->count++;
+    return 0;
+}
+
+// Get a stored point, index 0 is the oldest. Returns NULL if index is out of range.
+const gps_data_t *track_buffer_peek(const track_buffer_t *tb, uint16_t index)
+{
+    if (index >= tb->count) {
+        return NULL;
+    }
+    return &tb->points[(tb->head + index) % tb->capacity];
+}
+
+// Remove all points with a sequence number below end_seq (e.g. after their upload).
+// Points already overwritten are skipped.
+void track_buffer_release(track_buffer_t *tb, uint32_t end_seq)
+{
+    while (tb->count > 0 && (int32_t)(end_seq - tb->oldest_seq) > 0) {
+        tb->head = (uint16_t)((tb->head + 1) % tb->capacity);
+        tb->count--;
+        tb->oldest_seq++;
+    }
+}
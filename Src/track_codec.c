@@ -0,0 +1,182 @@
+#include "track_codec.h"
+
+#include <string.h>
+
+// Map a signed delta to an unsigned value with small magnitudes first (0, -1, 1, -2, ...)
+static inline uint64_t zigzag_encode(int64_t value)
+{
+    return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+}
+
+static inline int64_t zigzag_decode(uint64_t value)
+{
+    return (int64_t)(value >> 1) ^ -(int64_t)(value & 1);
+}
+
+// Write a varint (7 bits per byte, least significant group first). Returns the number of bytes.
+static uint32_t varint_put(uint8_t *buf, uint64_t value)
+{
+    uint32_t n = 0;
+
+    while (value >= 0x80) {
+        buf[n++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    buf[n++] = (uint8_t)value;
+    return n;
+}
+
+// Read a varint of at most 5 bytes. Returns the number of bytes, 0 if truncated or too long.
+static uint32_t varint_get(const uint8_t *buf, uint32_t len, uint64_t *value)
+{
+    *value = 0;
+    for (uint32_t n = 0; n < len && n < 5; n++) {
+        *value |= (uint64_t)(buf[n] & 0x7F) << (7 * n);
+        if ((buf[n] & 0x80) == 0) {
+            return n + 1;
+        }
+    }
+    return 0;
+}
+
+// Start a new batch in buf. size must be at least TRACK_BATCH_MIN_LEN.
+void track_encoder_init(track_encoder_t *enc, uint8_t *buf, uint32_t size)
+{
+    enc->buf = buf;
+    enc->size = size;
+    enc->len = TRACK_BATCH_HEADER_LEN;
+    enc->count = 0;
+}
+
+// Append a point: the first one as full record, the others as deltas to their predecessor.
+// Returns 0 on success, -1 if the batch is full (buffer or point count).
+int track_encoder_add(track_encoder_t *enc, const gps_data_t *point)
+{
+    uint8_t delta[TRACK_DELTA_MAX_LEN];
+    uint32_t n = 0;
+    uint32_t seconds = gps_to_seconds(point);
+
+    if (enc->count >= TRACK_BATCH_POINTS_MAX) {
+        return -1;
+    }
+
+    if (enc->count == 0) {
+        if (enc->len + GPS_PACKET_SIZE + 1 > enc->size) {
+            return -1;
+        }
+        enc->len += pack_gps(&enc->buf[enc->len], point);
+    } else {
+        n += varint_put(&delta[n], zigzag_encode((int64_t)point->latitude - enc->last.latitude));
+        n += varint_put(&delta[n], zigzag_encode((int64_t)point->longitude - enc->last.longitude));
+        n += varint_put(&delta[n], zigzag_encode((int64_t)seconds - enc->last_seconds));
+        n += varint_put(&delta[n], zigzag_encode((int64_t)point->altitude - enc->last.altitude));
+        n += varint_put(&delta[n], zigzag_encode((int64_t)point->speed - enc->last.speed));
+
+        // Keep one byte for the CRC
+        if (enc->len + n + 1 > enc->size) {
+            return -1;
+        }
+        memcpy(&enc->buf[enc->len], delta, n);
+        enc->len += n;
+    }
+
+    enc->last = *point;
+    enc->last_seconds = seconds;
+    enc->count++;
+    return 0;
+}
+
+// Complete the batch (point count and CRC). Returns its length in bytes, 0 if it holds no point.
+uint32_t track_encoder_finish(track_encoder_t *enc)
+{
+    if (enc->count == 0) {
+        return 0;
+    }
+
+    enc->buf[0] = TRACK_BATCH_VERSION;
+    enc->buf[1] = enc->count;
+    enc->buf[enc->len] = gps_crc8(enc->buf, enc->len);
+
+    return enc->len + 1;
+}
+
+// Apply the deltas of a batch to its first point, passing every point to the callback (if any).
+// Returns the position of the CRC, -1 if the deltas are truncated or out of range.
+static int32_t track_walk(const uint8_t *buf, uint32_t len, const gps_data_t *first,
+                          track_point_cb_t callback, void *ctx)
+{
+    uint32_t pos = TRACK_BATCH_HEADER_LEN + GPS_PACKET_SIZE;
+    int64_t latitude = first->latitude;
+    int64_t longitude = first->longitude;
+    int64_t seconds = gps_to_seconds(first);
+    int64_t altitude = first->altitude;
+    int64_t speed = first->speed;
+
+    if (callback != NULL) {
+        callback(first, ctx);
+    }
+
+    for (uint8_t i = 1; i < buf[1]; i++) {
+        int64_t *fields[] = { &latitude, &longitude, &seconds, &altitude, &speed };
+
+        for (uint8_t f = 0; f < sizeof(fields) / sizeof(fields[0]); f++) {
+            uint64_t value;
+            uint32_t n = varint_get(&buf[pos], len - pos, &value);
+
+            if (n == 0) {
+                return -1;
+            }
+            *fields[f] += zigzag_decode(value);
+            pos += n;
+        }
+
+        if (latitude < INT32_MIN || latitude > INT32_MAX || longitude < INT32_MIN || longitude > INT32_MAX ||
+            seconds < 0 || seconds > UINT32_MAX || altitude < 0 || altitude > UINT16_MAX ||
+            speed < 0 || speed > UINT16_MAX) {
+            return -1;
+        }
+
+        if (callback != NULL) {
+            gps_data_t point;
+
+            point.latitude = (int32_t)latitude;
+            point.longitude = (int32_t)longitude;
+            gps_from_seconds((uint32_t)seconds, &point);
+            point.altitude = (uint16_t)altitude;
+            point.speed = (uint16_t)speed;
+            callback(&point, ctx);
+        }
+    }
+
+    return (int32_t)pos;
+}
+
+// Decode a batch and pass each point to the callback. No point is reported unless the CRC matches.
+// Returns the length of the batch in bytes (further data may follow in buf),
+// -1 if it is truncated or malformed, -2 on a CRC mismatch, -3 on an unknown version.
+int32_t track_decode(const uint8_t *buf, uint32_t len, track_point_cb_t callback, void *ctx)
+{
+    gps_data_t first;
+
+    if (len < TRACK_BATCH_MIN_LEN || buf[1] == 0) {
+        return -1;
+    }
+    if (buf[0] != TRACK_BATCH_VERSION) {
+        return -3;
+    }
+    if (unpack_gps(&buf[TRACK_BATCH_HEADER_LEN], &first) != 0) {
+        return -1;
+    }
+
+    // Find the end first, then check the CRC before reporting any point
+    int32_t crc_pos = track_walk(buf, len, &first, NULL, NULL);
+    if (crc_pos < 0 || (uint32_t)crc_pos >= len) {
+        return -1;
+    }
+    if (gps_crc8(buf, (uint32_t)crc_pos) != buf[crc_pos]) {
+        return -2;
+    }
+
+    track_walk(buf, len, &first, callback, ctx);
+    return crc_pos + 1;
+}
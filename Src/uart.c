@@ -1,181 +1,1015 @@
 #include "uart.h"
 #include "gpio.h"
 #include "systick.h"
+#include "spsc_queue.h"
 #include <stdio.h>
 
 #include <stdint.h>
 #include <stddef.h>
-
-
-#define DBG_UART_BAUDRATE       115200
-#define UART1_BAUDRATE          115200
-#define SYS_FREQ                16000000
-#define APB1_CLK                SYS_FREQ
-#define APB2_CLK                SYS_FREQ
-
-// Forward declarations 
-static void uart_set_baudrate(USART_TypeDef *USARTx, uint32_t periph_clk, uint32_t baudrate);
-static uint16_t compute_uart_bd(uint32_t periph_clk, uint32_t baudrate);
+#include <string.h>
+
+
+// Maximum accepted deviation between requested and generated baudrate (in 1/1000).
+// The receiver tolerates roughly 3.5%, the remainder is left for the peer's clock error.
+#define UART_BAUD_MAX_ERR_PERMILLE  20
+
+// DMA stream interrupt flags, relative to the stream's position in LISR/HISR (and LIFCR/HIFCR)
+#define DMA_FLAG_FEIF           0x01U
+#define DMA_FLAG_DMEIF          0x04U
+#define DMA_FLAG_TEIF           0x08U
+#define DMA_FLAG_HTIF           0x10U
+#define DMA_FLAG_TCIF           0x20U
+#define DMA_FLAG_ALL            (DMA_FLAG_FEIF | DMA_FLAG_DMEIF | DMA_FLAG_TEIF | DMA_FLAG_HTIF | DMA_FLAG_TCIF)
+
+typedef struct {
+    GPIO_TypeDef *gpio;         // NULL if the signal is not available
+    uint8_t pin;
+} uart_pin_t;
+
+typedef struct {
+    DMA_TypeDef *dma;
+    DMA_Stream_TypeDef *stream;
+    uint8_t stream_num;         // 0-7, selects the flag position in LISR/HISR
+    uint8_t channel;            // Request channel (CHSEL)
+    IRQn_Type irqn;
+} uart_dma_desc_t;
+
+// Everything that differs between the UART instances
+typedef struct {
+    USART_TypeDef *usart;
+    volatile uint32_t *rcc_enr; // APB1ENR or APB2ENR
+    uint32_t rcc_en_mask;
+    uart_pin_t tx;
+    uart_pin_t rx;
+    uart_pin_t rts;
+    uart_pin_t cts;
+    GPIO_Af_TypeDef af;
+    IRQn_Type irqn;
+    uart_dma_desc_t rx_dma;
+    uart_dma_desc_t tx_dma;
+} uart_hw_desc_t;
+
+// Descriptor table, DMA mapping according to RM0090, Table 43/44
+static const uart_hw_desc_t uart_hw[UART_PORT_COUNT] = {
+    [UART_PORT_1] = {
+        .usart = USART1, .rcc_enr = &RCC->APB2ENR, .rcc_en_mask = RCC_APB2ENR_USART1EN,
+        .tx = {GPIOB, 6}, .rx = {GPIOB, 7}, .rts = {GPIOA, 12}, .cts = {GPIOA, 11},
+        .af = AF7, .irqn = USART1_IRQn,
+        .rx_dma = {DMA2, DMA2_Stream2, 2, 4, DMA2_Stream2_IRQn},
+        .tx_dma = {DMA2, DMA2_Stream7, 7, 4, DMA2_Stream7_IRQn},
+    },
+    [UART_PORT_2] = {
+        .usart = USART2, .rcc_enr = &RCC->APB1ENR, .rcc_en_mask = RCC_APB1ENR_USART2EN,
+        .tx = {GPIOA, 2}, .rx = {GPIOA, 3}, .rts = {GPIOA, 1}, .cts = {GPIOA, 0},
+        .af = AF7, .irqn = USART2_IRQn,
+        .rx_dma = {DMA1, DMA1_Stream5, 5, 4, DMA1_Stream5_IRQn},
+        .tx_dma = {DMA1, DMA1_Stream6, 6, 4, DMA1_Stream6_IRQn},
+    },
+    [UART_PORT_3] = {
+        .usart = USART3, .rcc_enr = &RCC->APB1ENR, .rcc_en_mask = RCC_APB1ENR_USART3EN,
+        .tx = {GPIOB, 10}, .rx = {GPIOB, 11}, .rts = {GPIOB, 14}, .cts = {GPIOB, 13},
+        .af = AF7, .irqn = USART3_IRQn,
+        .rx_dma = {DMA1, DMA1_Stream1, 1, 4, DMA1_Stream1_IRQn},
+        .tx_dma = {DMA1, DMA1_Stream3, 3, 4, DMA1_Stream3_IRQn},
+    },
+    [UART_PORT_4] = {
+        .usart = UART4, .rcc_enr = &RCC->APB1ENR, .rcc_en_mask = RCC_APB1ENR_UART4EN,
+        .tx = {GPIOC, 10}, .rx = {GPIOC, 11}, .rts = {NULL, 0}, .cts = {NULL, 0},
+        .af = AF8, .irqn = UART4_IRQn,
+        .rx_dma = {DMA1, DMA1_Stream2, 2, 4, DMA1_Stream2_IRQn},
+        .tx_dma = {DMA1, DMA1_Stream4, 4, 4, DMA1_Stream4_IRQn},
+    },
+    [UART_PORT_5] = {
+        .usart = UART5, .rcc_enr = &RCC->APB1ENR, .rcc_en_mask = RCC_APB1ENR_UART5EN,
+        .tx = {GPIOC, 12}, .rx = {GPIOD, 2}, .rts = {NULL, 0}, .cts = {NULL, 0},
+        .af = AF8, .irqn = UART5_IRQn,
+        .rx_dma = {DMA1, DMA1_Stream0, 0, 4, DMA1_Stream0_IRQn},
+        .tx_dma = {DMA1, DMA1_Stream7, 7, 4, DMA1_Stream7_IRQn},
+    },
+    [UART_PORT_6] = {
+        // RTS/CTS of USART6 are only routed to port G, which the 100-pin package does not have
+        .usart = USART6, .rcc_enr = &RCC->APB2ENR, .rcc_en_mask = RCC_APB2ENR_USART6EN,
+        .tx = {GPIOC, 6}, .rx = {GPIOC, 7}, .rts = {NULL, 0}, .cts = {NULL, 0},
+        .af = AF8, .irqn = USART6_IRQn,
+        .rx_dma = {DMA2, DMA2_Stream1, 1, 5, DMA2_Stream1_IRQn},
+        .tx_dma = {DMA2, DMA2_Stream6, 6, 5, DMA2_Stream6_IRQn},
+    },
+};
+
+// Runtime state of one port.
+// RX queue: produced by the RXNE interrupt, or by the DMA (then the reader publishes the DMA progress from NDTR).
+// TX queue: consumed by DMA, which always transmits the contiguous span at the read position, or by the TXE interrupt.
+typedef struct {
+    spsc_queue_t rx_q;
+    volatile uint32_t rx_idle_events;   // Number of completed RX bursts (IDLE line)
+    volatile uint32_t rx_idle_ndtr;     // DMA mode: NDTR at the last IDLE interrupt
+    volatile uint32_t rx_dma_halves;    // RX DMA half/full events since the start, for lap detection
+    spsc_queue_t tx_q;
+    volatile uint32_t tx_dma_len;       // Size of the running DMA transfer (0 = DMA idle)
+    volatile uart_tx_policy_t tx_policy;
+    volatile uint32_t tx_dropped;       // Bytes discarded by __io_putchar() or a timed-out uart_flush_tx()
+    volatile uint32_t tx_busy;          // Writes cut short under UART_TX_POLICY_DROP (the caller has the rest)
+    volatile uint32_t tx_blocked;
+    uart_stats_t stats;                 // Updated by the ISRs and the RX DMA sync, copied under PRIMASK
+    uint8_t rx_dma;
+    uint8_t tx_dma;
+    uint8_t initialized;
+} uart_state_t;
+
+static uart_state_t uart_state[UART_PORT_COUNT];
+
+// Forward declarations
+static int uart_apply_baudrate(USART_TypeDef *USARTx, uint32_t periph_clk, uint32_t baudrate);
+static int compute_uart_bd(uint32_t periph_clk, uint32_t baudrate, uint16_t *brr, uint8_t *over8);
+static uint32_t uart_get_pclk(USART_TypeDef *USARTx);
+static void uart_pin_init(const uart_pin_t *pin, GPIO_Af_TypeDef af, GPIO_PuPd_TypeDef pu_pd);
+static void uart_rx_dma_init(uart_port_t port, uint8_t irq_priority);
+static void uart_tx_dma_init(uart_port_t port, uint8_t irq_priority);
+static void uart_tx_dma_start(uart_port_t port);
+static void uart_tx_dma_complete(uart_port_t port);
+static void uart_tx_service(uart_port_t port);
+static void uart_tx_discard(uart_port_t port);
+static void uart_irq_handler(uart_port_t port);
+static void uart_tx_dma_irq_handler(uart_port_t port);
+static void uart_rx_dma_irq_handler(uart_port_t port);
+static void uart_rx_dma_sync(uart_port_t port);
 
 __attribute__((used))
 int __io_putchar(int ch)
 {
-    uart2_write(ch);
+    uint8_t byte = (uint8_t)(ch & 0xFF);
+
+    if (uart_write(DBG_UART, &byte, 1) == 0) {
+        uart_state[DBG_UART].tx_dropped++;
+    }
     return ch;
 }
 
-// Initialize UART1
-int uart1_init(void)
+// Check if a port is valid and has been initialized
+static inline int uart_ready(uart_port_t port)
 {
-    const uint8_t pb6 = 6;  // TX
-    const uint8_t pb7 = 7;  // RX
-
-    // Enable clock access to GPIOB
-    RCC->AHB1ENR |= RCC_AHB1ENR_GPIOBEN;
+    return (port < UART_PORT_COUNT) && uart_state[port].initialized;
+}
 
-    // Set (TX) to Push-Pull for clean signal edges
-    GPIO_SetOutType(GPIOB, pb6, PUSH_PULL); 
-    
-    // Set (RX) to use the internal Pull-Up resistor (CRITICAL for idle stability)
-    GPIO_SetPuPd(GPIOB, pb7, PULL_UP);
+// Check for a power of two that a single DMA transfer (16-bit NDTR) can cover
+static inline int uart_buf_size_valid(uint16_t size)
+{
+    return (size >= 2U) && (size <= 32768U) && ((size & (size - 1U)) == 0U);
+}
 
-    // Set the mode of PB6/PB7 (USART1_TX/_RX) to alternate function mode
-    GPIO_SetMode(GPIOB, pb6, GPIO_MODE_ALTERNATE);
-    GPIO_SetMode(GPIOB, pb7, GPIO_MODE_ALTERNATE);
+// DMA status register (LISR for streams 0-3, HISR for streams 4-7)
+static inline volatile uint32_t *dma_isr_reg(const uart_dma_desc_t *desc)
+{
+    return (desc->stream_num < 4U) ? &desc->dma->LISR : &desc->dma->HISR;
+}
 
-    // Set alternate function type to AF7(USART_TX)
-    GPIO_SetAlternateFunction(GPIOB, pb6, AF7);
-    // Set alternate function type to AF7(USART_RX )
-    GPIO_SetAlternateFunction(GPIOB, pb7, AF7);
+// DMA flag clear register (LIFCR for streams 0-3, HIFCR for streams 4-7)
+static inline volatile uint32_t *dma_ifcr_reg(const uart_dma_desc_t *desc)
+{
+    return (desc->stream_num < 4U) ? &desc->dma->LIFCR : &desc->dma->HIFCR;
+}
 
-    // Enable clock access to UART2
-    RCC->APB2ENR |= RCC_APB2ENR_USART1EN;
+// Bit position of a stream's flag group inside LISR/HISR
+static inline uint32_t dma_flag_shift(const uart_dma_desc_t *desc)
+{
+    static const uint8_t shift[4] = {0, 6, 16, 22};
+    return shift[desc->stream_num & 0x3U];
+}
 
-    // Configure UART baudrate (This should come first)
-    uart_set_baudrate(USART1, APB2_CLK, UART1_BAUDRATE);
+// Record the RX ring buffer fill level for the high-water mark
+static inline void uart_rx_track_fill(uart_state_t *st)
+{
+    uint32_t fill = spsc_queue_count(&st->rx_q);
 
-    // Configure transfer direction TX + RX 
-    USART1->CR1 |= (USART_CR1_TE | USART_CR1_RE);
+    if (fill > st->stats.rx_high_water) {
+        st->stats.rx_high_water = fill;
+    }
+}
 
-    // Set Pull-Up resisto on RX line 
-    // GPIO_SetPuPd(GPIOB, pb7, PULL_UP);
+// Record the TX ring buffer fill level for the high-water mark
+static inline void uart_tx_track_fill(uart_state_t *st)
+{
+    uint32_t fill = spsc_queue_count(&st->tx_q);
 
-    // Enable UART Module (This should be last)
-    USART1->CR1 |= USART_CR1_UE;
+    if (fill > st->stats.tx_high_water) {
+        st->stats.tx_high_water = fill;
+    }
+}
 
-    return 0;   // success
+// Store one received character (RXNE mode), dropped if the reader has fallen a full buffer behind
+static inline void uart_rx_store(uart_state_t *st, uint8_t ch)
+{
+    if (spsc_queue_push(&st->rx_q, ch) != 0) {
+        st->stats.rx_dropped++;
+        return;
+    }
+    st->stats.rx_bytes++;
+    uart_rx_track_fill(st);
 }
 
-// Initialize UART2
-int uart2_init(void)
+// Initialize a UART port: pins, clock, baudrate, ring buffers, DMA and interrupts
+int uart_init(uart_port_t port, const uart_config_t *config)
 {
-    const uint8_t pa2 = 2;  // TX
-    const uint8_t pa3 = 3;  // RX
+    // Input parameter check
+    if (port >= UART_PORT_COUNT || config == NULL) {
+        return -1;
+    }
+
+    if (config->rx_buf == NULL || config->tx_buf == NULL ||
+        !uart_buf_size_valid(config->rx_buf_size) || !uart_buf_size_valid(config->tx_buf_size)) {
+        return -1;
+    }
 
-    // Enable clock access to GPIOA
-    RCC->AHB1ENR |= RCC_AHB1ENR_GPIOAEN;
+    const uart_hw_desc_t *hw = &uart_hw[port];
+    uart_state_t *st = &uart_state[port];
+    USART_TypeDef *USARTx = hw->usart;
 
-    // Set (TX) to Push-Pull for clean signal edges
-    GPIO_SetOutType(GPIOA, pa2, PUSH_PULL); 
-    
-    // Set (RX) to use the internal Pull-Up resistor (CRITICAL for idle stability)
-    GPIO_SetPuPd(GPIOA, pa3, PULL_UP);
+    if (config->flow_control && (hw->rts.gpio == NULL || hw->cts.gpio == NULL)) {
+        return -1;  // This instance has no RTS/CTS pins
+    }
 
-    // Set the mode of PA2/PA3 (USART2_TX/_RX) to alternate function mode
-    GPIO_SetMode(GPIOA, pa2, GPIO_MODE_ALTERNATE);
-    GPIO_SetMode(GPIOA, pa3, GPIO_MODE_ALTERNATE);
+    // Set (TX) to Push-Pull for clean signal edges, (RX) to use the internal Pull-Up resistor (CRITICAL for idle stability)
+    uart_pin_init(&hw->tx, hw->af, NO_PUPD);
+    uart_pin_init(&hw->rx, hw->af, PULL_UP);
 
-    // Set alternate function type to AF7(USART_TX)
-    GPIO_SetAlternateFunction(GPIOA, pa2, AF7);
-    // Set alternate function type to AF7(USART2_RX )
-    GPIO_SetAlternateFunction(GPIOA, pa3, AF7);
+    // Enable clock access to the UART
+    *hw->rcc_enr |= hw->rcc_en_mask;
 
-    // Enable clock access to UART2
-    RCC->APB1ENR |= RCC_APB1ENR_USART2EN;
+    // Stop the UART and its interrupt while it is reconfigured
+    NVIC_DisableIRQ(hw->irqn);
+    USARTx->CR1 = 0;
+    USARTx->CR3 = 0;
 
     // Configure UART baudrate (This should come first)
-    uart_set_baudrate(USART2, APB1_CLK, DBG_UART_BAUDRATE);
+    if (uart_apply_baudrate(USARTx, uart_get_pclk(USARTx), config->baudrate) != 0) {
+        return -1;
+    }
+
+    // Reset the runtime state
+    spsc_queue_init(&st->rx_q, config->rx_buf, config->rx_buf_size);
+    spsc_queue_init(&st->tx_q, config->tx_buf, config->tx_buf_size);
+    st->rx_idle_events = 0;
+    st->tx_dma_len = 0;
+    st->tx_policy = config->tx_policy;
+    st->tx_dropped = 0;
+    st->tx_busy = 0;
+    st->tx_blocked = 0;
+    memset(&st->stats, 0, sizeof(st->stats));
+    st->rx_dma = config->rx_dma ? 1 : 0;
+    st->tx_dma = config->tx_dma ? 1 : 0;
+
+    // Configure transfer direction TX + RX, IDLE marks the end of every RX burst
+    USARTx->CR1 |= (USART_CR1_TE | USART_CR1_RE | USART_CR1_IDLEIE);
+
+    // Reception: circular DMA, or one interrupt per character
+    // In DMA mode line errors raise their own interrupt (EIE), otherwise they come with RXNE
+    if (st->rx_dma) {
+        uart_rx_dma_init(port, config->irq_priority);
+        USARTx->CR3 |= (USART_CR3_DMAR | USART_CR3_EIE);
+    } else {
+        USARTx->CR1 |= USART_CR1_RXNEIE;
+    }
+
+    // Transmission: DMA from the TX ring buffer, otherwise TXE interrupt (enabled on demand)
+    if (st->tx_dma) {
+        uart_tx_dma_init(port, config->irq_priority);
+        USARTx->CR3 |= USART_CR3_DMAT;
+    }
 
-    // Configure transfer direction TX + RX 
-    USART2->CR1 |= (USART_CR1_TE | USART_CR1_RE);
+    st->initialized = 1;
+
+    if (config->flow_control) {
+        uart_set_flow_control(port, 1);
+    }
+
+    NVIC_SetPriority(hw->irqn, config->irq_priority);
+    NVIC_EnableIRQ(hw->irqn);
 
     // Enable UART Module (This should be last)
-    USART2->CR1 |= USART_CR1_UE;
+    USARTx->CR1 |= USART_CR1_UE;
 
     return 0;   // success
 }
 
-// Non-blocking write: attempts to write the character and returns status.
-int uart1_write_nb(int ch)
+// Check if the port can generate the given baudrate within tolerance
+int uart_baudrate_supported(uart_port_t port, uint32_t baudrate)
 {
-    // Check if the Transmit Data Register is empty (TXE).
-    if (USART1->SR & USART_SR_TXE) {
-        // Hardware is ready: write the character.
-        USART1->DR = (ch & 0xFF);
-        return 0; // Success
-    } else {
-        // Hardware is NOT ready (transmit buffer is full).
-        return -1; // Failure: buffer busy
+    if (port >= UART_PORT_COUNT) {
+        return 0;
     }
+
+    uint16_t brr;
+    uint8_t over8;
+    USART_TypeDef *USARTx = uart_hw[port].usart;
+    int err = compute_uart_bd(uart_get_pclk(USARTx), baudrate, &brr, &over8);
+
+    return (err >= 0 && err <= UART_BAUD_MAX_ERR_PERMILLE);
 }
 
-// Non-blocking read: checks for data and returns character or error.
-int uart1_read_nb(void)
+// Change the baudrate on the fly. Everything queued for transmission is sent first (blocks
+// like uart_flush_tx(), for at most UART_FLUSH_TIMEOUT_MS); a running RX DMA keeps going and
+// continues at the new rate.
+// Returns 0 on success, -1 if the baudrate is out of tolerance (setting unchanged).
+int uart_set_baudrate(uart_port_t port, uint32_t baudrate)
 {
-    // Check if the Receive Data Register is NOT empty (RXNE).
-    if (USART1->SR & USART_SR_RXNE) {
-        // Data is ready: read the character.
-        int ch = USART1->DR & 0xFF;
-        return ch; // Success: returns the received character (0-255)
+    if (!uart_ready(port) || !uart_baudrate_supported(port, baudrate)) {
+        return -1;
+    }
+
+    USART_TypeDef *USARTx = uart_hw[port].usart;
+
+    // BRR must not change while a character is being sent. What is still queued after the
+    // timeout is dropped, it would be garbled at the new rate anyway.
+    uart_flush_tx(port, UART_FLUSH_TIMEOUT_MS);
+
+    USARTx->CR1 &= ~USART_CR1_UE;
+    uart_apply_baudrate(USARTx, uart_get_pclk(USARTx), baudrate);
+    USARTx->CR1 |= USART_CR1_UE;
+
+    return 0;   // success
+}
+
+// Enable or disable RTS/CTS hardware flow control.
+// Returns 0 on success, -1 if the port has no flow control pins.
+int uart_set_flow_control(uart_port_t port, uint8_t enable)
+{
+    if (port >= UART_PORT_COUNT) {
+        return -1;
+    }
+
+    const uart_hw_desc_t *hw = &uart_hw[port];
+
+    if (hw->rts.gpio == NULL || hw->cts.gpio == NULL) {
+        return -1;
+    }
+
+    if (enable) {
+        // Keep CTS high (= stop sending) while the peer does not drive it
+        uart_pin_init(&hw->rts, hw->af, NO_PUPD);
+        uart_pin_init(&hw->cts, hw->af, PULL_UP);
+        hw->usart->CR3 |= (USART_CR3_RTSE | USART_CR3_CTSE);
     } else {
-        // No data available.
+        hw->usart->CR3 &= ~(USART_CR3_RTSE | USART_CR3_CTSE);
+
+        // Release the pins
+        GPIO_SetMode(hw->rts.gpio, hw->rts.pin, GPIO_MODE_INPUT);
+        GPIO_SetMode(hw->cts.gpio, hw->cts.pin, GPIO_MODE_INPUT);
+    }
+
+    return 0;
+}
+
+// Non-blocking read: returns the next character from the RX ring buffer or -1.
+int uart_read_nb(uart_port_t port)
+{
+    if (!uart_ready(port)) {
+        return -1;
+    }
+
+    uint8_t ch;
+
+    uart_rx_dma_sync(port);
+    if (spsc_queue_pop(&uart_state[port].rx_q, &ch) != 0) {
         return -1; // Failure: no data
     }
+    return ch; // Success: returns the received character (0-255)
 }
 
-// Flushes the UART1 RX Buffer by reading all available data
-void uart1_flush_rx_buffer(void) {
+// Returns the number of bytes waiting in the RX ring buffer
+size_t uart_rx_available(uart_port_t port)
+{
+    if (!uart_ready(port)) {
+        return 0;
+    }
+
+    uart_rx_dma_sync(port);
+    return spsc_queue_count(&uart_state[port].rx_q);
+}
 
-    // Loop as long as the RXNE flag is set 
-    while((USART1->SR & USART_SR_RXNE) != 0) {
-      (void)USART1->DR; // read register data into dummy variable 
+// Zero-copy read: points span at the contiguous buffered bytes at the read position,
+// without consuming them. Returns the span length; the bytes stay valid until uart_rx_consume().
+size_t uart_rx_peek(uart_port_t port, const uint8_t **span)
+{
+    if (!uart_ready(port) || span == NULL) {
+        return 0;
     }
+
+    uart_rx_dma_sync(port);
+    return spsc_queue_peek_read(&uart_state[port].rx_q, span);
 }
 
-__attribute__((used))   // don't optimize this function away
-int uart2_write(int ch)
+// Release len bytes previously returned by uart_rx_peek()
+void uart_rx_consume(uart_port_t port, size_t len)
 {
-    // Make sure transmit data register is empty
-    while(!(USART2->SR & USART_SR_TXE)) {}
+    if (!uart_ready(port)) {
+        return;
+    }
 
-    // Write to transmit data register 
-    USART2->DR = (ch & 0xFF);
-    return 0;   // success
+    spsc_queue_commit_read(&uart_state[port].rx_q, (uint32_t)len);
 }
 
-__attribute__((used))   // don't optimize this function away
-int uart2_read(void)
+// Returns the number of IDLE-line events seen so far. Every increment marks the end
+// of a burst from the peer: all bytes of that burst are already in the ring buffer.
+uint32_t uart_rx_idle_count(uart_port_t port)
 {
-    // Wait until data is received (SR_RXNE = 1)
-    while(!(USART2->SR & USART_SR_RXNE)) {}
+    if (!uart_ready(port)) {
+        return 0;
+    }
 
-    // Read character from data register
-    int ch = USART2->DR & 0xFF;
-    return ch;
+    uart_rx_dma_sync(port);     // Also enables IDLE again in DMA mode
+    return uart_state[port].rx_idle_events;
+}
+
+// Flushes the RX ring buffer by discarding all buffered data
+void uart_flush_rx(uart_port_t port)
+{
+    if (!uart_ready(port)) {
+        return;
+    }
+
+    // Only the consumer index is moved, so the ISR/DMA keeps running undisturbed
+    uart_rx_dma_sync(port);
+    spsc_queue_discard(&uart_state[port].rx_q);
+}
+
+// Non-blocking write: queues the character if there is space, returns 0 or -1 (buffer full).
+int uart_write_nb(uart_port_t port, int ch)
+{
+    if (!uart_ready(port)) {
+        return -1;
+    }
+
+    uart_state_t *st = &uart_state[port];
+
+    if (spsc_queue_push(&st->tx_q, (uint8_t)(ch & 0xFF)) != 0) {
+        return -1; // Failure: buffer full
+    }
+    uart_tx_track_fill(st);
+    uart_tx_service(port);
+
+    return 0; // Success
+}
+
+// Queue len bytes for transmission and return immediately.
+// If the TX ring buffer runs full, the overflow policy decides whether the call
+// returns early (the caller keeps the rest) or waits for the hardware to free space.
+// Returns the number of bytes queued.
+size_t uart_write(uart_port_t port, const uint8_t *data, size_t len)
+{
+    if (!uart_ready(port) || data == NULL || len == 0) {
+        return 0;
+    }
+
+    uart_state_t *st = &uart_state[port];
+    size_t queued = 0;
+    uint8_t blocked = 0;
+
+    while (queued < len) {
+        // Copy as much as fits
+        uint32_t n = spsc_queue_push_n(&st->tx_q, &data[queued], (uint32_t)(len - queued));
+        queued += n;
+        uart_tx_track_fill(st);
+
+        if (n == 0) {
+            if (st->tx_policy == UART_TX_POLICY_DROP) {
+                st->tx_busy++;
+                break;
+            }
+
+            // UART_TX_POLICY_BLOCK: wait until the running transfer has freed some space
+            if (!blocked) {
+                blocked = 1;
+                st->tx_blocked++;
+            }
+        }
+
+        // Start the transmission if it is idle
+        uart_tx_service(port);
+    }
+
+    return queued;
+}
+
+// Select what happens when the TX ring buffer is full
+void uart_set_tx_policy(uart_port_t port, uart_tx_policy_t policy)
+{
+    if (port < UART_PORT_COUNT) {
+        uart_state[port].tx_policy = policy;
+    }
+}
+
+// Number of bytes printf() output has lost to a full TX ring buffer, or a timed-out
+// uart_flush_tx() has discarded, since initialization
+uint32_t uart_tx_dropped(uart_port_t port)
+{
+    return (port < UART_PORT_COUNT) ? uart_state[port].tx_dropped : 0;
+}
+
+// Number of writes that had to wait for free space under UART_TX_POLICY_BLOCK
+uint32_t uart_tx_blocked(uart_port_t port)
+{
+    return (port < UART_PORT_COUNT) ? uart_state[port].tx_blocked : 0;
+}
+
+// Block until every queued byte has left the shift register (e.g. before a reset), at most timeout_ms.
+// Output that cannot leave in time (e.g. held back by CTS from a silent peer) is discarded.
+// Returns 0 when everything was sent, -1 on timeout or invalid port.
+int uart_flush_tx(uart_port_t port, uint32_t timeout_ms)
+{
+    if (!uart_ready(port)) {
+        return -1;
+    }
+
+    uart_state_t *st = &uart_state[port];
+    uint32_t start = system_get_tick_ms();
+
+    while ((spsc_queue_count(&st->tx_q) != 0) || (st->tx_dma_len != 0)) {
+        if ((system_get_tick_ms() - start) >= timeout_ms) {
+            uart_tx_discard(port);
+            return -1;
+        }
+        uart_tx_service(port);
+    }
+
+    // The stream disables itself after its last write to DR
+    if (st->tx_dma) {
+        while (uart_hw[port].tx_dma.stream->CR & DMA_SxCR_EN) {}
+    }
+
+    // Wait for the last stop bit (Transmission Complete)
+    while (!(uart_hw[port].usart->SR & USART_SR_TC)) {
+        if ((system_get_tick_ms() - start) >= timeout_ms) {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+// Copy the counters of a port. Returns 0 on success, -1 on invalid parameters.
+int uart_get_stats(uart_port_t port, uart_stats_t *stats)
+{
+    if (port >= UART_PORT_COUNT || stats == NULL) {
+        return -1;
+    }
+
+    // Take a consistent snapshot (the ISRs update several fields at once)
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    *stats = uart_state[port].stats;
+    __set_PRIMASK(primask);
+
+    return 0;
+}
+
+// Restart all counters and high-water marks of a port from zero
+void uart_reset_stats(uart_port_t port)
+{
+    if (port >= UART_PORT_COUNT) {
+        return;
+    }
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    memset(&uart_state[port].stats, 0, sizeof(uart_state[port].stats));
+    __set_PRIMASK(primask);
+}
+
+// Print the counters of a port (debug output)
+void uart_print_stats(uart_port_t port)
+{
+    uart_stats_t st;
+
+    if (uart_get_stats(port, &st) != 0) {
+        return;
+    }
+
+    printf("UART%d: rx %lu B (dropped %lu, overruns %lu, high-water %lu/%lu), tx %lu B (dropped %lu, busy %lu, blocked %lu, high-water %lu/%lu)\r\n",
+           port + 1, st.rx_bytes, st.rx_dropped, st.rx_overrun, st.rx_high_water, uart_state[port].rx_q.size,
+           st.tx_bytes, uart_state[port].tx_dropped, uart_state[port].tx_busy, uart_state[port].tx_blocked, st.tx_high_water, uart_state[port].tx_q.size);
+    printf("UART%d: errors ORE %lu, FE %lu, NE %lu, PE %lu; DMA rx half %lu, rx full %lu, tx blocks %lu\r\n",
+           port + 1, st.overrun_errors, st.framing_errors, st.noise_errors, st.parity_errors,
+           st.rx_dma_half, st.rx_dma_full, st.tx_dma_blocks);
+}
+
+// Shared USART interrupt: RX characters (RXNE mode), line errors, end of RX bursts, TX characters (TXE mode)
+static void uart_irq_handler(uart_port_t port)
+{
+    uart_state_t *st = &uart_state[port];
+    USART_TypeDef *USARTx = uart_hw[port].usart;
+    // DMA position before the SR read: a DMA read of DR after it finishes the clear sequence of IDLE
+    uint32_t ndtr = st->rx_dma ? uart_hw[port].rx_dma.stream->NDTR : 0;
+    uint32_t sr = USARTx->SR;
+
+    // Line errors, counted once per flag occurrence
+    if (sr & (USART_SR_ORE | USART_SR_NE | USART_SR_FE | USART_SR_PE)) {
+        if (sr & USART_SR_ORE) st->stats.overrun_errors++;
+        if (sr & USART_SR_NE)  st->stats.noise_errors++;
+        if (sr & USART_SR_FE)  st->stats.framing_errors++;
+        if (sr & USART_SR_PE)  st->stats.parity_errors++;
+
+        // DMA mode (EIE): DR belongs to the DMA, whose next read completes the SR-then-DR
+        // sequence that clears the flags. Mask the error interrupt until then,
+        // uart_rx_dma_sync() enables it again once the flags are gone.
+        if (st->rx_dma) {
+            USARTx->CR3 &= ~USART_CR3_EIE;
+        }
+    }
+
+    // RXNE: data ready. ORE/NE/FE are cleared by the same SR-then-DR read sequence,
+    // which also clears an IDLE seen above: keep it for the check below.
+    if (!st->rx_dma && (sr & (USART_SR_RXNE | USART_SR_ORE | USART_SR_NE | USART_SR_FE))) {
+        uart_rx_store(st, (uint8_t)(USARTx->DR & 0xFF));
+        sr = USARTx->SR | (sr & USART_SR_IDLE);
+    }
+
+    // IDLE: the peer has finished a burst. Cleared by the SR-then-DR read sequence.
+    if ((USARTx->CR1 & USART_CR1_IDLEIE) && (sr & USART_SR_IDLE)) {
+        st->rx_idle_events++;
+
+        if (st->rx_dma) {
+            // DR belongs to the DMA, whose read of the next character clears the flag.
+            // Mask the interrupt until then, uart_rx_dma_sync() enables it again.
+            st->rx_idle_ndtr = ndtr;
+            USARTx->CR1 &= ~USART_CR1_IDLEIE;
+        } else {
+            uint8_t ch = (uint8_t)(USARTx->DR & 0xFF);
+
+            // A character may have arrived since the RXNE read: keep it
+            if (sr & USART_SR_RXNE) {
+                uart_rx_store(st, ch);
+            }
+        }
+    }
+
+    // TXE (interrupt-driven TX only): feed the next character or stop when the ring is empty
+    if ((USARTx->CR1 & USART_CR1_TXEIE) && (sr & USART_SR_TXE)) {
+        uint8_t ch;
+
+        if (spsc_queue_pop(&st->tx_q, &ch) == 0) {
+            USARTx->DR = ch;
+            st->stats.tx_bytes++;
+        } else {
+            USARTx->CR1 &= ~USART_CR1_TXEIE;
+        }
+    }
 }
 
-// Helper function to compute UART baudrate 
-static uint16_t compute_uart_bd(uint32_t periph_clk, uint32_t baudrate)
+// Shared TX DMA interrupt: a TX block has been handed to the USART
+static void uart_tx_dma_irq_handler(uart_port_t port)
 {
-    return ((periph_clk + (baudrate)/2U)/baudrate);
+    const uart_dma_desc_t *desc = &uart_hw[port].tx_dma;
+    uint32_t flags = (*dma_isr_reg(desc) >> dma_flag_shift(desc)) & DMA_FLAG_ALL;
+
+    if (flags & (DMA_FLAG_TCIF | DMA_FLAG_TEIF)) {
+        uart_tx_dma_complete(port);
+    }
 }
 
-// Helper function to set UART baudrate 
-static void uart_set_baudrate(USART_TypeDef *USARTx, uint32_t periph_clk, uint32_t baudrate)
+// Shared RX DMA interrupt: half/full events of the circular transfer. The reader derives
+// the data position from NDTR; the event count tells it how many laps the DMA has made.
+static void uart_rx_dma_irq_handler(uart_port_t port)
 {
-    USARTx->BRR = compute_uart_bd(periph_clk, baudrate);
+    const uart_dma_desc_t *desc = &uart_hw[port].rx_dma;
+    uart_state_t *st = &uart_state[port];
+    uint32_t shift = dma_flag_shift(desc);
+    uint32_t flags = (*dma_isr_reg(desc) >> shift) & DMA_FLAG_ALL;
+
+    *dma_ifcr_reg(desc) = flags << shift;
+
+    if (flags & DMA_FLAG_HTIF) {
+        st->stats.rx_dma_half++;
+        st->rx_dma_halves++;
+    }
+    if (flags & DMA_FLAG_TCIF) {
+        st->stats.rx_dma_full++;
+        st->rx_dma_halves++;
+    }
 }
 
+void USART1_IRQHandler(void) { uart_irq_handler(UART_PORT_1); }
+void USART2_IRQHandler(void) { uart_irq_handler(UART_PORT_2); }
+void USART3_IRQHandler(void) { uart_irq_handler(UART_PORT_3); }
+void UART4_IRQHandler(void)  { uart_irq_handler(UART_PORT_4); }
+void UART5_IRQHandler(void)  { uart_irq_handler(UART_PORT_5); }
+void USART6_IRQHandler(void) { uart_irq_handler(UART_PORT_6); }
+
+void DMA2_Stream7_IRQHandler(void) { uart_tx_dma_irq_handler(UART_PORT_1); }
+void DMA1_Stream6_IRQHandler(void) { uart_tx_dma_irq_handler(UART_PORT_2); }
+void DMA1_Stream3_IRQHandler(void) { uart_tx_dma_irq_handler(UART_PORT_3); }
+void DMA1_Stream4_IRQHandler(void) { uart_tx_dma_irq_handler(UART_PORT_4); }
+void DMA1_Stream7_IRQHandler(void) { uart_tx_dma_irq_handler(UART_PORT_5); }
+void DMA2_Stream6_IRQHandler(void) { uart_tx_dma_irq_handler(UART_PORT_6); }
+
+void DMA2_Stream2_IRQHandler(void) { uart_rx_dma_irq_handler(UART_PORT_1); }
+void DMA1_Stream5_IRQHandler(void) { uart_rx_dma_irq_handler(UART_PORT_2); }
+void DMA1_Stream1_IRQHandler(void) { uart_rx_dma_irq_handler(UART_PORT_3); }
+void DMA1_Stream2_IRQHandler(void) { uart_rx_dma_irq_handler(UART_PORT_4); }
+void DMA1_Stream0_IRQHandler(void) { uart_rx_dma_irq_handler(UART_PORT_5); }
+void DMA2_Stream1_IRQHandler(void) { uart_rx_dma_irq_handler(UART_PORT_6); }
+
+// Configure a GPIO pin for its UART alternate function
+static void uart_pin_init(const uart_pin_t *pin, GPIO_Af_TypeDef af, GPIO_PuPd_TypeDef pu_pd)
+{
+    // Enable clock access to the GPIO port (ports are 0x400 apart, enable bits in the same order)
+    RCC->AHB1ENR |= (1UL << (((uint32_t)pin->gpio - GPIOA_BASE) / 0x400UL));
 
+    GPIO_SetOutType(pin->gpio, pin->pin, PUSH_PULL);
+    GPIO_SetPuPd(pin->gpio, pin->pin, pu_pd);
+    GPIO_SetMode(pin->gpio, pin->pin, GPIO_MODE_ALTERNATE);
+    GPIO_SetAlternateFunction(pin->gpio, pin->pin, af);
+}
 
+// Enable clock access to the DMA controller of a stream
+static void uart_dma_clock_enable(const uart_dma_desc_t *desc)
+{
+    RCC->AHB1ENR |= (desc->dma == DMA1) ? RCC_AHB1ENR_DMA1EN : RCC_AHB1ENR_DMA2EN;
+}
 
+// Configure the RX DMA stream to copy USARTx->DR into the RX ring buffer forever
+static void uart_rx_dma_init(uart_port_t port, uint8_t irq_priority)
+{
+    const uart_hw_desc_t *hw = &uart_hw[port];
+    const uart_dma_desc_t *desc = &hw->rx_dma;
+    uart_state_t *st = &uart_state[port];
+
+    uart_dma_clock_enable(desc);
+
+    // Disable the stream and wait until it is really stopped before reconfiguring
+    desc->stream->CR &= ~DMA_SxCR_EN;
+    while (desc->stream->CR & DMA_SxCR_EN) {}
+
+    // Clear all pending stream flags
+    *dma_ifcr_reg(desc) = DMA_FLAG_ALL << dma_flag_shift(desc);
+
+    desc->stream->PAR  = (uint32_t)&hw->usart->DR;
+    desc->stream->M0AR = (uint32_t)st->rx_q.buf;
+    desc->stream->NDTR = st->rx_q.size;
+    desc->stream->FCR  = 0;     // Direct mode, no FIFO
+    st->rx_dma_halves = 0;
+
+    // Peripheral-to-memory, byte transfers, memory increment, circular, high priority,
+    // half/full interrupts to count the laps
+    desc->stream->CR = ((uint32_t)desc->channel << DMA_SxCR_CHSEL_Pos) |
+                       DMA_SxCR_PL_1 |
+                       DMA_SxCR_MINC |
+                       DMA_SxCR_CIRC |
+                       DMA_SxCR_HTIE |
+                       DMA_SxCR_TCIE;
+
+    NVIC_SetPriority(desc->irqn, irq_priority);
+    NVIC_EnableIRQ(desc->irqn);
+
+    // Start the stream
+    desc->stream->CR |= DMA_SxCR_EN;
+}
+
+// Configure the TX DMA stream for memory-to-peripheral transfers into USARTx->DR
+static void uart_tx_dma_init(uart_port_t port, uint8_t irq_priority)
+{
+    const uart_hw_desc_t *hw = &uart_hw[port];
+    const uart_dma_desc_t *desc = &hw->tx_dma;
+
+    uart_dma_clock_enable(desc);
+
+    // Disable the stream and wait until it is really stopped before reconfiguring
+    desc->stream->CR &= ~DMA_SxCR_EN;
+    while (desc->stream->CR & DMA_SxCR_EN) {}
+
+    // Clear all pending stream flags
+    *dma_ifcr_reg(desc) = DMA_FLAG_ALL << dma_flag_shift(desc);
+
+    desc->stream->PAR = (uint32_t)&hw->usart->DR;
+    desc->stream->FCR = 0;      // Direct mode, no FIFO
+
+    // Memory-to-peripheral, byte transfers, memory increment, transfer complete/error interrupts
+    desc->stream->CR = ((uint32_t)desc->channel << DMA_SxCR_CHSEL_Pos) |
+                       DMA_SxCR_DIR_0 |
+                       DMA_SxCR_MINC |
+                       DMA_SxCR_TCIE |
+                       DMA_SxCR_TEIE;
+
+    NVIC_SetPriority(desc->irqn, irq_priority);
+    NVIC_EnableIRQ(desc->irqn);
+}
+
+// Start a transfer of the contiguous span at the read position. Must run with the DMA interrupt masked.
+static void uart_tx_dma_start(uart_port_t port)
+{
+    const uart_dma_desc_t *desc = &uart_hw[port].tx_dma;
+    uart_state_t *st = &uart_state[port];
+
+    if (st->tx_dma_len != 0) {
+        return; // Busy
+    }
+
+    // Send up to the end of the buffer; the wrapped part follows with the next transfer.
+    // The span stays owned by the DMA until it is committed on completion.
+    const uint8_t *span;
+    uint32_t len = spsc_queue_peek_read(&st->tx_q, &span);
+
+    if (len == 0) {
+        return; // Nothing to send
+    }
+
+    st->tx_dma_len = len;
+    *dma_ifcr_reg(desc) = DMA_FLAG_ALL << dma_flag_shift(desc);
+    desc->stream->M0AR = (uint32_t)span;
+    desc->stream->NDTR = len;
+    desc->stream->CR |= DMA_SxCR_EN;
+}
+
+// Release the transmitted block and chain the next one. Must run with the DMA interrupt masked.
+static void uart_tx_dma_complete(uart_port_t port)
+{
+    const uart_dma_desc_t *desc = &uart_hw[port].tx_dma;
+    uart_state_t *st = &uart_state[port];
+
+    *dma_ifcr_reg(desc) = DMA_FLAG_ALL << dma_flag_shift(desc);
+    spsc_queue_commit_read(&st->tx_q, st->tx_dma_len);
+    st->stats.tx_bytes += st->tx_dma_len;
+    st->stats.tx_dma_blocks++;
+    st->tx_dma_len = 0;
+    uart_tx_dma_start(port);
+}
+
+// Kick the transmission from thread context. Also does the interrupt's work itself
+// (complete a finished DMA block / feed TXE), so blocking writers and uart_flush_tx()
+// make progress even with interrupts disabled.
+static void uart_tx_service(uart_port_t port)
+{
+    const uart_hw_desc_t *hw = &uart_hw[port];
+    uart_state_t *st = &uart_state[port];
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+
+    if (st->tx_dma) {
+        uint32_t flags = (*dma_isr_reg(&hw->tx_dma) >> dma_flag_shift(&hw->tx_dma)) & DMA_FLAG_ALL;
+
+        if (flags & (DMA_FLAG_TCIF | DMA_FLAG_TEIF)) {
+            uart_tx_dma_complete(port);
+        } else {
+            uart_tx_dma_start(port);
+        }
+    } else if (spsc_queue_count(&st->tx_q) != 0) {
+        uint8_t ch;
+
+        if ((hw->usart->SR & USART_SR_TXE) && spsc_queue_pop(&st->tx_q, &ch) == 0) {
+            hw->usart->DR = ch;
+            st->stats.tx_bytes++;
+        }
+        hw->usart->CR1 |= USART_CR1_TXEIE;  // The interrupt sends the rest
+    }
+
+    __set_PRIMASK(primask);
+}
+
+// Drop everything queued for transmission, including the block of a running DMA transfer.
+// The dropped bytes are counted as tx_dropped.
+static void uart_tx_discard(uart_port_t port)
+{
+    const uart_hw_desc_t *hw = &uart_hw[port];
+    uart_state_t *st = &uart_state[port];
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+
+    if (st->tx_dma) {
+        // The stream stops after the current data item
+        hw->tx_dma.stream->CR &= ~DMA_SxCR_EN;
+        while (hw->tx_dma.stream->CR & DMA_SxCR_EN) {}
+        *dma_ifcr_reg(&hw->tx_dma) = DMA_FLAG_ALL << dma_flag_shift(&hw->tx_dma);
+        st->tx_dma_len = 0;
+    } else {
+        hw->usart->CR1 &= ~USART_CR1_TXEIE;
+    }
+
+    st->tx_dropped += spsc_queue_count(&st->tx_q);
+    spsc_queue_discard(&st->tx_q);
+
+    __set_PRIMASK(primask);
+}
+
+// DMA mode: publish the bytes the DMA has written since the last call to the RX queue.
+// Only called by the reader, which therefore also acts as the queue's producer.
+static void uart_rx_dma_sync(uart_port_t port)
+{
+    uart_state_t *st = &uart_state[port];
+
+    if (!st->rx_dma) {
+        return;
+    }
+
+    spsc_queue_t *q = &st->rx_q;
+    USART_TypeDef *USARTx = uart_hw[port].usart;
+
+    // Line error reported: enable its interrupt again once the DMA's read has cleared the flags
+    if (!(USARTx->CR3 & USART_CR3_EIE) && !(USARTx->SR & (USART_SR_ORE | USART_SR_NE | USART_SR_FE))) {
+        uint32_t primask = __get_PRIMASK();
+        __disable_irq();
+        USARTx->CR3 |= USART_CR3_EIE;
+        __set_PRIMASK(primask);
+    }
+
+    // End of a burst reported: enable its interrupt again once the DMA has read a character
+    // since, which cleared the flag. If that burst has ended as well, the interrupt follows at once.
+    if (!(USARTx->CR1 & USART_CR1_IDLEIE) && uart_hw[port].rx_dma.stream->NDTR != st->rx_idle_ndtr) {
+        uint32_t primask = __get_PRIMASK();
+        __disable_irq();
+        USARTx->CR1 |= USART_CR1_IDLEIE;
+        __set_PRIMASK(primask);
+    }
+
+    // NDTR counts down from the buffer size and reloads automatically in circular mode, so it
+    // cannot tell a full lap from none. The half/full events count the halves the DMA has
+    // completed (read first: the interrupt of a boundary just crossed may still be pending,
+    // which leaves the position within one buffer of that count).
+    uint32_t half = q->size / 2U;
+    uint32_t base = st->rx_dma_halves * half;
+    uint32_t dma_pos = (q->size - uart_hw[port].rx_dma.stream->NDTR) & q->mask;
+    uint32_t written = base + ((dma_pos - base) & q->mask);    // Bytes written since the start
+    uint32_t fresh = written - q->head;
+
+    if (fresh == 0) {
+        return;
+    }
+    spsc_queue_commit_write(q, fresh);
+    st->stats.rx_bytes += fresh;
+
+    // The reader has fallen more than a buffer behind: the oldest bytes are already overwritten
+    uint32_t count = spsc_queue_count(q);
+    if (count > q->size) {
+        spsc_queue_commit_read(q, count - q->size);
+        st->stats.rx_dropped += count - q->size;
+        st->stats.rx_overrun++;
+    }
+    uart_rx_track_fill(st);
+}
+
+// Helper function to compute the UART baudrate register.
+// pclk / baudrate, rounded, equals USARTDIV * 16 (OVER8 = 0) as well as USARTDIV * 8 (OVER8 = 1),
+// so both modes give the same resolution. Oversampling by 16 is preferred for its better noise
+// immunity, oversampling by 8 extends the range up to pclk / 8 for high baudrates.
+// Returns the deviation of the generated baudrate in 1/1000, or -1 if the rate cannot be generated.
+static int compute_uart_bd(uint32_t periph_clk, uint32_t baudrate, uint16_t *brr, uint8_t *over8)
+{
+    if (baudrate == 0) {
+        return -1;
+    }
+
+    uint32_t div = (periph_clk + (baudrate / 2U)) / baudrate;
+
+    if (div >= 16U && div <= 0xFFFFU) {
+        *brr = (uint16_t)div;                                       // Mantissa [15:4], fraction [3:0]
+        *over8 = 0;
+    } else if (div >= 8U && div < 16U) {
+        *brr = (uint16_t)(((div & ~0x7U) << 1) | (div & 0x7U));     // Mantissa [15:4], fraction [2:0]
+        *over8 = 1;
+    } else {
+        return -1;  // Mantissa would be 0 or overflow
+    }
+
+    uint32_t actual = periph_clk / div;
+    uint32_t diff = (actual > baudrate) ? (actual - baudrate) : (baudrate - actual);
+
+    return (int)(((uint64_t)diff * 1000U) / baudrate);
+}
+
+// Helper function to set UART baudrate (UE must be cleared while OVER8 is changed)
+// Returns 0 on success, -1 if the baudrate cannot be generated within tolerance.
+static int uart_apply_baudrate(USART_TypeDef *USARTx, uint32_t periph_clk, uint32_t baudrate)
+{
+    uint16_t brr;
+    uint8_t over8;
+    int err = compute_uart_bd(periph_clk, baudrate, &brr, &over8);
+
+    if (err < 0 || err > UART_BAUD_MAX_ERR_PERMILLE) {
+        return -1;
+    }
+
+    if (over8) {
+        USARTx->CR1 |= USART_CR1_OVER8;
+    } else {
+        USARTx->CR1 &= ~USART_CR1_OVER8;
+    }
+    USARTx->BRR = brr;
+
+    return 0;
+}
+
+// Helper function to get the clock of the APB bus a UART is connected to
+static uint32_t uart_get_pclk(USART_TypeDef *USARTx)
+{
+    // APB prescaler encoding: 0xx = /1, 100 = /2, 101 = /4, 110 = /8, 111 = /16
+    uint32_t ppre;
+
+    if (USARTx == USART1 || USARTx == USART6) {
+        ppre = (RCC->CFGR & RCC_CFGR_PPRE2_Msk) >> RCC_CFGR_PPRE2_Pos;    // APB2
+    } else {
+        ppre = (RCC->CFGR & RCC_CFGR_PPRE1_Msk) >> RCC_CFGR_PPRE1_Pos;    // APB1
+    }
+
+    if (ppre < 4U) {
+        return SystemCoreClock;
+    }
+    return SystemCoreClock >> (ppre - 3U);
+}
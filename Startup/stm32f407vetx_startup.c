@@ -43,6 +43,24 @@ void DebugMon_Handler(void)   __attribute__((weak, alias("Default_Handler")));
 void PendSV_Handler(void)     __attribute__((weak, alias("Default_Handler")));
 void SysTick_Handler(void)    __attribute__((weak, alias("Default_Handler")));
 void EXTI4_IRQHandler(void)   __attribute__((weak, alias("Default_Handler")));
+void DMA1_Stream0_IRQHandler(void) __attribute__((weak, alias("Default_Handler")));
+void DMA1_Stream1_IRQHandler(void) __attribute__((weak, alias("Default_Handler")));
+void DMA1_Stream2_IRQHandler(void) __attribute__((weak, alias("Default_Handler")));
+void DMA1_Stream3_IRQHandler(void) __attribute__((weak, alias("Default_Handler")));
+void DMA1_Stream4_IRQHandler(void) __attribute__((weak, alias("Default_Handler")));
+void DMA1_Stream5_IRQHandler(void) __attribute__((weak, alias("Default_Handler")));
+void DMA1_Stream6_IRQHandler(void) __attribute__((weak, alias("Default_Handler")));
+void DMA1_Stream7_IRQHandler(void) __attribute__((weak, alias("Default_Handler")));
+void DMA2_Stream1_IRQHandler(void) __attribute__((weak, alias("Default_Handler")));
+void DMA2_Stream2_IRQHandler(void) __attribute__((weak, alias("Default_Handler")));
+void DMA2_Stream6_IRQHandler(void) __attribute__((weak, alias("Default_Handler")));
+void DMA2_Stream7_IRQHandler(void) __attribute__((weak, alias("Default_Handler")));
+void USART1_IRQHandler(void)       __attribute__((weak, alias("Default_Handler")));
+void USART2_IRQHandler(void)       __attribute__((weak, alias("Default_Handler")));
+void USART3_IRQHandler(void)       __attribute__((weak, alias("Default_Handler")));
+void UART4_IRQHandler(void)        __attribute__((weak, alias("Default_Handler")));
+void UART5_IRQHandler(void)        __attribute__((weak, alias("Default_Handler")));
+void USART6_IRQHandler(void)       __attribute__((weak, alias("Default_Handler")));
 
 
 // Vector table (order matters!)
@@ -83,6 +101,128 @@ uint32_t vector_tbl[] __attribute__((section(".isr_vector_tbl"))) = {
     (uint32_t)&Default_Handler,
     // IRQ10 - EXTI4
     (uint32_t)&EXTI4_IRQHandler,
+    // IRQ11 - DMA1_Stream0
+    (uint32_t)&DMA1_Stream0_IRQHandler,
+    // IRQ12 - DMA1_Stream1
+    (uint32_t)&DMA1_Stream1_IRQHandler,
+    // IRQ13 - DMA1_Stream2
+    (uint32_t)&DMA1_Stream2_IRQHandler,
+    // IRQ14 - DMA1_Stream3
+    (uint32_t)&DMA1_Stream3_IRQHandler,
+    // IRQ15 - DMA1_Stream4
+    (uint32_t)&DMA1_Stream4_IRQHandler,
+    // IRQ16 - DMA1_Stream5
+    (uint32_t)&DMA1_Stream5_IRQHandler,
+    // IRQ17 - DMA1_Stream6
+    (uint32_t)&DMA1_Stream6_IRQHandler,
+    // IRQ18 - ADC
+    (uint32_t)&Default_Handler,
+    // IRQ19 - CAN1_TX
+    (uint32_t)&Default_Handler,
+    // IRQ20 - CAN1_RX0
+    (uint32_t)&Default_Handler,
+    // IRQ21 - CAN1_RX1
+    (uint32_t)&Default_Handler,
+    // IRQ22 - CAN1_SCE
+    (uint32_t)&Default_Handler,
+    // IRQ23 - EXTI9_5
+    (uint32_t)&Default_Handler,
+    // IRQ24 - TIM1_BRK_TIM9
+    (uint32_t)&Default_Handler,
+    // IRQ25 - TIM1_UP_TIM10
+    (uint32_t)&Default_Handler,
+    // IRQ26 - TIM1_TRG_COM_TIM11
+    (uint32_t)&Default_Handler,
+    // IRQ27 - TIM1_CC
+    (uint32_t)&Default_Handler,
+    // IRQ28 - TIM2
+    (uint32_t)&Default_Handler,
+    // IRQ29 - TIM3
+    (uint32_t)&Default_Handler,
+    // IRQ30 - TIM4
+    (uint32_t)&Default_Handler,
+    // IRQ31 - I2C1_EV
+    (uint32_t)&Default_Handler,
+    // IRQ32 - I2C1_ER
+    (uint32_t)&Default_Handler,
+    // IRQ33 - I2C2_EV
+    (uint32_t)&Default_Handler,
+    // IRQ34 - I2C2_ER
+    (uint32_t)&Default_Handler,
+    // IRQ35 - SPI1
+    (uint32_t)&Default_Handler,
+    // IRQ36 - SPI2
+    (uint32_t)&Default_Handler,
+    // IRQ37 - USART1
+    (uint32_t)&USART1_IRQHandler,
+    // IRQ38 - USART2
+    (uint32_t)&USART2_IRQHandler,
+    // IRQ39 - USART3
+    (uint32_t)&USART3_IRQHandler,
+    // IRQ40 - EXTI15_10
+    (uint32_t)&Default_Handler,
+    // IRQ41 - RTC_Alarm
+    (uint32_t)&Default_Handler,
+    // IRQ42 - OTG_FS_WKUP
+    (uint32_t)&Default_Handler,
+    // IRQ43 - TIM8_BRK_TIM12
+    (uint32_t)&Default_Handler,
+    // IRQ44 - TIM8_UP_TIM13
+    (uint32_t)&Default_Handler,
+    // IRQ45 - TIM8_TRG_COM_TIM14
+    (uint32_t)&Default_Handler,
+    // IRQ46 - TIM8_CC
+    (uint32_t)&Default_Handler,
+    // IRQ47 - DMA1_Stream7
+    (uint32_t)&DMA1_Stream7_IRQHandler,
+    // IRQ48 - FSMC
+    (uint32_t)&Default_Handler,
+    // IRQ49 - SDIO
+    (uint32_t)&Default_Handler,
+    // IRQ50 - TIM5
+    (uint32_t)&Default_Handler,
+    // IRQ51 - SPI3
+    (uint32_t)&Default_Handler,
+    // IRQ52 - UART4
+    (uint32_t)&UART4_IRQHandler,
+    // IRQ53 - UART5
+    (uint32_t)&UART5_IRQHandler,
+    // IRQ54 - TIM6_DAC
+    (uint32_t)&Default_Handler,
+    // IRQ55 - TIM7
+    (uint32_t)&Default_Handler,
+    // IRQ56 - DMA2_Stream0
+    (uint32_t)&Default_Handler,
+    // IRQ57 - DMA2_Stream1
+    (uint32_t)&DMA2_Stream1_IRQHandler,
+    // IRQ58 - DMA2_Stream2
+    (uint32_t)&DMA2_Stream2_IRQHandler,
+    // IRQ59 - DMA2_Stream3
+    (uint32_t)&Default_Handler,
+    // IRQ60 - DMA2_Stream4
+    (uint32_t)&Default_Handler,
+    // IRQ61 - ETH
+    (uint32_t)&Default_Handler,
+    // IRQ62 - ETH_WKUP
+    (uint32_t)&Default_Handler,
+    // IRQ63 - CAN2_TX
+    (uint32_t)&Default_Handler,
+    // IRQ64 - CAN2_RX0
+    (uint32_t)&Default_Handler,
+    // IRQ65 - CAN2_RX1
+    (uint32_t)&Default_Handler,
+    // IRQ66 - CAN2_SCE
+    (uint32_t)&Default_Handler,
+    // IRQ67 - OTG_FS
+    (uint32_t)&Default_Handler,
+    // IRQ68 - DMA2_Stream5
+    (uint32_t)&Default_Handler,
+    // IRQ69 - DMA2_Stream6
+    (uint32_t)&DMA2_Stream6_IRQHandler,
+    // IRQ70 - DMA2_Stream7
+    (uint32_t)&DMA2_Stream7_IRQHandler,
+    // IRQ71 - USART6
+    (uint32_t)&USART6_IRQHandler,
     // ... continue for rest if needed
 };
 
@@ -0,0 +1,88 @@
+// Benchmark of the AT line classifier: generated prefix trie (at_trie_classify()) against the
+// linear StatusLookupTable scan it replaced, on a transcript of modem responses.
+// Both must classify every line of the corpus the same way.
+//
+// Build and run: make host-test
+// Usage: bench_at_classify [corpus]    (default: tests/data/at_responses.txt)
+
+#include "at_trie.h"
+#include "host_test.h"
+
+#define BENCH_ROUNDS    20000
+
+typedef struct {
+    const char *string;
+    AtResponseStatus_t status;
+} AtLookupEntry_t;
+
+// Reference: the lookup table of the former parse_at_line(), built from the same definitions
+static const AtLookupEntry_t StatusLookupTable[] = {
+#define AT_STATUS(prefix, status) {prefix, status},
+#include "at_status.def"
+#undef AT_STATUS
+    {NULL, (AtResponseStatus_t)0}
+};
+
+// Reference: the former parse_at_line(), first matching table entry wins
+static AtResponseStatus_t parse_at_line_linear(const char *line, size_t len)
+{
+    if (line == NULL) {
+        return AT_INVALID_PARAM;
+    }
+
+    for (size_t i = 0; StatusLookupTable[i].string != NULL; i++) {
+        size_t prefix_len = strlen(StatusLookupTable[i].string);
+
+        if (len >= prefix_len && strncmp(line, StatusLookupTable[i].string, prefix_len) == 0) {
+            return StatusLookupTable[i].status;
+        }
+    }
+
+    return AT_RX_PARTIAL;
+}
+
+static host_corpus_t corpus;
+
+// Time per line of one classifier over the whole corpus
+static double bench(AtResponseStatus_t (*classify)(const char *line, size_t len))
+{
+    volatile uint32_t sink = 0;
+    uint64_t start = host_now_ns();
+
+    for (uint32_t round = 0; round < BENCH_ROUNDS; round++) {
+        for (size_t i = 0; i < corpus.count; i++) {
+            sink += (uint32_t)classify(corpus.text[i], corpus.len[i]);
+        }
+    }
+    (void)sink;
+
+    return (double)(host_now_ns() - start) / ((double)BENCH_ROUNDS * (double)corpus.count);
+}
+
+int main(int argc, char *argv[])
+{
+    const char *path = (argc > 1) ? argv[1] : "tests/data/at_responses.txt";
+
+    if (host_load_corpus(&corpus, path) != 0 || corpus.count == 0) {
+        return 1;
+    }
+
+    for (size_t i = 0; i < corpus.count; i++) {
+        AtResponseStatus_t expected = parse_at_line_linear(corpus.text[i], corpus.len[i]);
+        AtResponseStatus_t status = at_trie_classify(corpus.text[i], corpus.len[i]);
+
+        if (status != expected) {
+            printf("\"%s\": trie %d, table %d\n", corpus.text[i], status, expected);
+        }
+        CHECK(status == expected);
+    }
+
+    double linear_ns = bench(parse_at_line_linear);
+    double trie_ns = bench(at_trie_classify);
+
+    printf("%zu lines from %s\n", corpus.count, path);
+    printf("linear table scan: %6.1f ns/line\n", linear_ns);
+    printf("prefix trie:       %6.1f ns/line (%.1fx faster)\n", trie_ns, linear_ns / trie_ns);
+
+    return host_test_result("bench_at_classify");
+}
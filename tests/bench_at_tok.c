@@ -0,0 +1,295 @@
+// Benchmark of the response parsers (Src/sim7600e_parse.c, based on at_tok) against the
+// strstr()/sscanf() parsers they replaced, on the information lines of a modem transcript.
+// Both must return the same result for every line of the corpus.
+//
+// Build and run: make host-test
+// Usage: bench_at_tok [corpus]    (default: tests/data/at_responses.txt)
+
+#include "sim7600e.h"
+#include "host_test.h"
+
+#define BENCH_ROUNDS    20000
+#define RESULT_LEN      96
+
+// Reference: the former parse_creg_status()
+static CregState_t parse_creg_status_sscanf(const char *response_str)
+{
+    const char *start_pos = strstr(response_str, "+CREG: ");
+    int n = -1;
+    int stat = -1;
+
+    if (start_pos == NULL || sscanf(start_pos + strlen("+CREG: "), "%d,%d", &n, &stat) != 2) {
+        return CREG_STATE_INVALID;
+    }
+
+    switch (stat) {
+        case 0: return CREG_STATE_NOT_REGISTERED;
+        case 1: return CREG_STATE_HOME_NETWORK;
+        case 2: return CREG_STATE_SEARCHING;
+        case 3: return CREG_STATE_DENIED;
+        case 4: return CREG_STATE_UNKNOWN;
+        case 5: return CREG_STATE_ROAMING;
+        default: return CREG_STATE_INVALID;
+    }
+}
+
+// Reference: the former parse_cgps_status()
+static CgpsState_t parse_cgps_status_sscanf(const char *response_str)
+{
+    const char *start_pos = strstr(response_str, "+CGPS: ");
+    int mode = -1;
+    int type = -1;
+
+    if (start_pos == NULL) {
+        return CGPS_STATE_INVALID;
+    }
+
+    int scan_count = sscanf(start_pos + strlen("+CGPS: "), "%d,%d", &mode, &type);
+
+    if (mode == 0 && scan_count >= 1) {
+        return CGPS_STATE_OFF;
+    }
+    if (mode == 1 && scan_count == 2) {
+        if (type == 1) return CGPS_STATE_ON_STANDALONE;
+        if (type == 2) return CGPS_STATE_ON_AGPS_UE;
+        if (type == 3) return CGPS_STATE_ON_AGPS_ASSIST;
+    }
+    return CGPS_STATE_INVALID;
+}
+
+// Reference: the former parse_cgpsinfo_state()
+static CgpsState_t parse_cgpsinfo_state_sscanf(const char **response_str)
+{
+    const char *start_pos = strstr(*response_str, "+CGPSINFO: ");
+
+    if (start_pos != NULL) {
+        if (strstr(start_pos, "+CGPSINFO: ,,,,,,,,") != NULL) {
+            return CGPS_STATE_NO_FIX;
+        }
+
+        const char *latitude_start = start_pos + strlen("+CGPSINFO: ");
+        if (*latitude_start != ',') {
+            *response_str = latitude_start;
+            return CGPS_STATE_FIX_AVAILABLE;
+        }
+    }
+    return CGPS_STATE_INVALID;
+}
+
+// Reference: the scan of the former parse_csq_status(), the RSSI/BER mapping is unchanged
+static CsqState_t parse_csq_status_sscanf(const char *response_str, CsqResult_t *result)
+{
+    const char *start_pos = strstr(response_str, "+CSQ: ");
+
+    if (start_pos == NULL ||
+        sscanf(start_pos + strlen("+CSQ: "), "%d,%d", &result->raw_rssi, &result->raw_ber) != 2) {
+        return CSQ_STATE_INVALID;
+    }
+    return CSQ_STATE_OK;
+}
+
+// Reference: the former parse_cgatt_status()
+static CgattState_t parse_cgatt_status_sscanf(const char *response_str)
+{
+    const char *start_pos = strstr(response_str, "+CGATT: ");
+    int state = -1;
+
+    if (start_pos == NULL || sscanf(start_pos + strlen("+CGATT: "), "%d", &state) != 1) {
+        return CGATT_STATE_INVALID;
+    }
+    if (state == 0) {
+        return CGATT_STATE_DETACHED;
+    }
+    return (state == 1) ? CGATT_STATE_ATTACHED : CGATT_STATE_INVALID;
+}
+
+// Reference: the former parse_cgpaddr_status() (without its debug printf)
+static CgpaddrState_t parse_cgpaddr_status_sscanf(const char *response_str, char *ip_addr)
+{
+    const char *start_pos = strstr(response_str, "+CGPADDR: ");
+    int cid = -1;
+
+    ip_addr[0] = '\0';
+    if (start_pos == NULL || sscanf(start_pos + strlen("+CGPADDR: "), "%d,%[0-9.]", &cid, ip_addr) != 2) {
+        return CGPADDR_STATE_INVALID;
+    }
+    return (ip_addr[0] == '\0') ? CGPADDR_STATE_NOT_ACTIVE : CGPADDR_STATE_OK;
+}
+
+// Reference: the former parse_cgact_status()
+static int parse_cgact_status_sscanf(const char *response_str, int cid)
+{
+    const char *info_prefix = "+CGACT: ";
+
+    for (const char *pos = strstr(response_str, info_prefix); pos != NULL; pos = strstr(pos, info_prefix)) {
+        int line_cid = -1;
+        int state = -1;
+
+        pos += strlen(info_prefix);
+        if (sscanf(pos, "%d,%d", &line_cid, &state) == 2 && line_cid == cid) {
+            return (state == 0 || state == 1) ? state : -1;
+        }
+    }
+    return -1;
+}
+
+// One parser run on a line. Returns the parser's result; the values it extracted are written
+// to detail (if not NULL), so that both versions can be compared outside the timed loops.
+typedef int (*parse_fn_t)(const char *line, char *detail);
+
+static int creg_tok(const char *line, char *detail)     { (void)detail; return parse_creg_status(line); }
+static int creg_sscanf(const char *line, char *detail)  { (void)detail; return parse_creg_status_sscanf(line); }
+static int cgps_tok(const char *line, char *detail)     { (void)detail; return parse_cgps_status(line); }
+static int cgps_sscanf(const char *line, char *detail)  { (void)detail; return parse_cgps_status_sscanf(line); }
+static int cgatt_tok(const char *line, char *detail)    { (void)detail; return parse_cgatt_status(line); }
+static int cgatt_sscanf(const char *line, char *detail) { (void)detail; return parse_cgatt_status_sscanf(line); }
+static int cgact_tok(const char *line, char *detail)    { (void)detail; return parse_cgact_status(line, 1); }
+static int cgact_sscanf(const char *line, char *detail) { (void)detail; return parse_cgact_status_sscanf(line, 1); }
+
+static int cgpsinfo_tok(const char *line, char *detail)
+{
+    CgpsState_t state = parse_cgpsinfo_state(&line);
+
+    if (detail != NULL) {
+        snprintf(detail, RESULT_LEN, "%s", line);
+    }
+    return state;
+}
+
+static int cgpsinfo_sscanf(const char *line, char *detail)
+{
+    CgpsState_t state = parse_cgpsinfo_state_sscanf(&line);
+
+    if (detail != NULL) {
+        snprintf(detail, RESULT_LEN, "%s", line);
+    }
+    return state;
+}
+
+static int csq_tok(const char *line, char *detail)
+{
+    CsqResult_t csq = { -1, -1, RSSI_STATE_INVALID, BER_STATE_INVALID };
+    CsqState_t state = parse_csq_status(line, &csq);
+
+    if (detail != NULL) {
+        snprintf(detail, RESULT_LEN, "%d,%d", csq.raw_rssi, csq.raw_ber);
+    }
+    return state;
+}
+
+static int csq_sscanf(const char *line, char *detail)
+{
+    CsqResult_t csq = { -1, -1, RSSI_STATE_INVALID, BER_STATE_INVALID };
+    CsqState_t state = parse_csq_status_sscanf(line, &csq);
+
+    if (detail != NULL) {
+        snprintf(detail, RESULT_LEN, "%d,%d", csq.raw_rssi, csq.raw_ber);
+    }
+    return state;
+}
+
+static int cgpaddr_tok(const char *line, char *detail)
+{
+    char ip_addr[IPV6_ADDR_MAX_LEN];
+    CgpaddrState_t state = parse_cgpaddr_status(line, ip_addr);
+
+    if (detail != NULL) {
+        snprintf(detail, RESULT_LEN, "%s", ip_addr);
+    }
+    return state;
+}
+
+static int cgpaddr_sscanf(const char *line, char *detail)
+{
+    char ip_addr[IPV6_ADDR_MAX_LEN];
+    CgpaddrState_t state = parse_cgpaddr_status_sscanf(line, ip_addr);
+
+    if (detail != NULL) {
+        snprintf(detail, RESULT_LEN, "%s", ip_addr);
+    }
+    return state;
+}
+
+typedef struct {
+    const char *prefix;         // Information lines handled by the parser
+    parse_fn_t tok;             // at_tok version
+    parse_fn_t reference;       // Former strstr/sscanf version
+} parser_pair_t;
+
+static const parser_pair_t parsers[] = {
+    { "+CREG: ",     creg_tok,     creg_sscanf },
+    { "+CGPS: ",     cgps_tok,     cgps_sscanf },
+    { "+CGPSINFO: ", cgpsinfo_tok, cgpsinfo_sscanf },
+    { "+CSQ: ",      csq_tok,      csq_sscanf },
+    { "+CGATT: ",    cgatt_tok,    cgatt_sscanf },
+    { "+CGPADDR: ",  cgpaddr_tok,  cgpaddr_sscanf },
+    { "+CGACT: ",    cgact_tok,    cgact_sscanf },
+};
+
+static host_corpus_t corpus;
+static const parser_pair_t *line_parser[sizeof(corpus.len) / sizeof(corpus.len[0])];
+
+// Time per parsed line of one parser set over the information lines of the corpus
+static double bench(int use_tok, size_t lines)
+{
+    volatile uint32_t sink = 0;
+    uint64_t start = host_now_ns();
+
+    for (uint32_t round = 0; round < BENCH_ROUNDS; round++) {
+        for (size_t i = 0; i < corpus.count; i++) {
+            if (line_parser[i] != NULL) {
+                parse_fn_t parse = use_tok ? line_parser[i]->tok : line_parser[i]->reference;
+                sink += (uint32_t)parse(corpus.text[i], NULL);
+            }
+        }
+    }
+    (void)sink;
+
+    return (double)(host_now_ns() - start) / ((double)BENCH_ROUNDS * (double)lines);
+}
+
+int main(int argc, char *argv[])
+{
+    const char *path = (argc > 1) ? argv[1] : "tests/data/at_responses.txt";
+    size_t lines = 0;
+
+    if (host_load_corpus(&corpus, path) != 0 || corpus.count == 0) {
+        return 1;
+    }
+
+    for (size_t i = 0; i < corpus.count; i++) {
+        for (size_t p = 0; p < sizeof(parsers) / sizeof(parsers[0]); p++) {
+            if (strncmp(corpus.text[i], parsers[p].prefix, strlen(parsers[p].prefix)) == 0) {
+                line_parser[i] = &parsers[p];
+            }
+        }
+        if (line_parser[i] == NULL) {
+            continue;
+        }
+        lines++;
+
+        char expected[RESULT_LEN] = "";
+        char detail[RESULT_LEN] = "";
+        int expected_state = line_parser[i]->reference(corpus.text[i], expected);
+        int state = line_parser[i]->tok(corpus.text[i], detail);
+
+        if (state != expected_state || strcmp(detail, expected) != 0) {
+            printf("\"%s\": at_tok %d \"%s\", sscanf %d \"%s\"\n",
+                   corpus.text[i], state, detail, expected_state, expected);
+        }
+        CHECK(state == expected_state && strcmp(detail, expected) == 0);
+    }
+    CHECK(lines > 0);
+    if (lines == 0) {
+        return host_test_result("bench_at_tok");
+    }
+
+    double sscanf_ns = bench(0, lines);
+    double tok_ns = bench(1, lines);
+
+    printf("%zu information lines from %s\n", lines, path);
+    printf("strstr/sscanf: %6.1f ns/line\n", sscanf_ns);
+    printf("at_tok:        %6.1f ns/line (%.1fx faster)\n", tok_ns, sscanf_ns / tok_ns);
+
+    return host_test_result("bench_at_tok");
+}
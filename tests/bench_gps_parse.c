@@ -0,0 +1,199 @@
+// Benchmark of the single-pass +CGPSINFO parser (parse_gps_info()) against the sscanf()-based
+// parser it replaced, on a set of +CGPSINFO lines. Both must accept and reject the same lines
+// and return the same fix.
+//
+// Build and run: make host-test
+// Usage: bench_gps_parse [corpus]    (default: tests/data/cgpsinfo.txt)
+
+#include "gps.h"
+#include "host_test.h"
+
+#include <stdlib.h>
+
+#define BENCH_ROUNDS        20000
+#define NMEA_MINUTE_DIGITS  6
+#define CGPSINFO_PREFIX     "+CGPSINFO: "
+
+// Reference: the former nmea_to_coord(), (d)ddmm.mmmmmm and N/S/E/W to 1e-7 degrees
+static int nmea_to_coord_ref(const char *str, char dir, int32_t *coord)
+{
+    uint32_t whole = 0;
+    uint32_t fraction = 0;
+    uint8_t digits = 0;
+    uint32_t max_degrees;
+
+    if (dir == 'N' || dir == 'S') {
+        max_degrees = 90;
+    } else if (dir == 'E' || dir == 'W') {
+        max_degrees = 180;
+    } else {
+        return -1;
+    }
+
+    while (*str >= '0' && *str <= '9') {
+        if (++digits > 5) {
+            return -1;
+        }
+        whole = whole * 10 + (uint32_t)(*str++ - '0');
+    }
+    if (digits < 3) {
+        return -1;
+    }
+
+    if (*str == '.') {
+        str++;
+        digits = 0;
+        while (*str >= '0' && *str <= '9') {
+            if (digits < NMEA_MINUTE_DIGITS) {
+                fraction = fraction * 10 + (uint32_t)(*str - '0');
+                digits++;
+            }
+            str++;
+        }
+        while (digits++ < NMEA_MINUTE_DIGITS) {
+            fraction *= 10;
+        }
+    }
+    if (*str != '\0' && *str != ',') {
+        return -1;
+    }
+
+    uint32_t degrees = whole / 100;
+    uint32_t minutes = (whole % 100) * 1000000UL + fraction;
+
+    if (minutes >= 60000000UL || degrees > max_degrees || (degrees == max_degrees && minutes > 0)) {
+        return -1;
+    }
+
+    int32_t value = (int32_t)(degrees * (uint32_t)GPS_COORD_SCALE + (minutes + 3) / 6);
+    *coord = (dir == 'S' || dir == 'W') ? -value : value;
+    return 0;
+}
+
+// Reference: the former parse_gps_info() (without its debug output)
+static int parse_gps_info_sscanf(const char *gps_info, gps_data_t *gps_data)
+{
+    char lat_str[16], lon_str[16];
+    char alt_str[16], speed_str[16];
+    char date_str[16], time_str[16];
+    char ns, ew;
+    int day, month, year;
+    int hour, minute, second;
+    int32_t latitude;
+    int32_t longitude;
+
+    int scan_count = sscanf(gps_info, "%15[^,],%c,%15[^,],%c,%15[^,],%15[^,],%15[^,],%15[^,],",
+                            lat_str, &ns, lon_str, &ew, date_str, time_str, alt_str, speed_str);
+    if (scan_count != 8) {
+        return -2;
+    }
+
+    uint16_t altitude = (uint16_t)strtol(alt_str, NULL, 10);
+    float speed = strtof(speed_str, NULL);
+
+    if (nmea_to_coord_ref(lat_str, ns, &latitude) != 0 || nmea_to_coord_ref(lon_str, ew, &longitude) != 0) {
+        return -2;
+    }
+
+    gps_data->latitude  = latitude;
+    gps_data->longitude = longitude;
+    gps_data->altitude  = altitude;
+    gps_data->speed     = (uint16_t)(speed * 100);
+
+    if (sscanf(date_str, "%2d%2d%2d", &day, &month, &year) != 3) {
+        return -3;
+    }
+    gps_data->day = (uint8_t)day;
+    gps_data->month = (uint8_t)month;
+    gps_data->year = (uint8_t)year;
+
+    if (sscanf(time_str, "%2d%2d%2d", &hour, &minute, &second) != 3) {
+        return -4;
+    }
+    gps_data->hour = (uint8_t)hour;
+    gps_data->minute = (uint8_t)minute;
+    gps_data->second = (uint8_t)second;
+
+    return 0;
+}
+
+// Same fix; the former float conversion of the speed may come out 0.01 km/h low
+static int gps_same_fix(const gps_data_t *a, const gps_data_t *b)
+{
+    int speed_diff = (int)a->speed - (int)b->speed;
+
+    return a->latitude == b->latitude && a->longitude == b->longitude &&
+           a->year == b->year && a->month == b->month && a->day == b->day &&
+           a->hour == b->hour && a->minute == b->minute && a->second == b->second &&
+           a->altitude == b->altitude && speed_diff >= 0 && speed_diff <= 1;
+}
+
+static host_corpus_t corpus;
+
+// Payload of a corpus line, without the +CGPSINFO prefix
+static const char *payload(size_t i)
+{
+    const char *line = corpus.text[i];
+
+    return (strncmp(line, CGPSINFO_PREFIX, strlen(CGPSINFO_PREFIX)) == 0) ? line + strlen(CGPSINFO_PREFIX) : line;
+}
+
+static int parse_single_pass(const char *gps_info, gps_data_t *gps_data)
+{
+    return parse_gps_info(gps_info, gps_data, 0);
+}
+
+// Time per line of one parser over the whole corpus
+static double bench(int (*parse)(const char *gps_info, gps_data_t *gps_data))
+{
+    volatile uint32_t sink = 0;
+    gps_data_t data;
+
+    memset(&data, 0, sizeof(data));
+    uint64_t start = host_now_ns();
+
+    for (uint32_t round = 0; round < BENCH_ROUNDS; round++) {
+        for (size_t i = 0; i < corpus.count; i++) {
+            sink += (uint32_t)parse(payload(i), &data) + data.second;
+        }
+    }
+    (void)sink;
+
+    return (double)(host_now_ns() - start) / ((double)BENCH_ROUNDS * (double)corpus.count);
+}
+
+int main(int argc, char *argv[])
+{
+    const char *path = (argc > 1) ? argv[1] : "tests/data/cgpsinfo.txt";
+    size_t fixes = 0;
+
+    if (host_load_corpus(&corpus, path) != 0 || corpus.count == 0) {
+        return 1;
+    }
+
+    for (size_t i = 0; i < corpus.count; i++) {
+        gps_data_t expected;
+        gps_data_t data;
+
+        memset(&expected, 0, sizeof(expected));
+        memset(&data, 0, sizeof(data));
+        int expected_rv = parse_gps_info_sscanf(payload(i), &expected);
+        int rv = parse_gps_info(payload(i), &data, 0);
+
+        if (rv != expected_rv || (rv == 0 && !gps_same_fix(&data, &expected))) {
+            printf("\"%s\": single pass %d, sscanf %d\n", corpus.text[i], rv, expected_rv);
+        }
+        CHECK(rv == expected_rv);
+        CHECK(rv != 0 || gps_same_fix(&data, &expected));
+        fixes += (rv == 0);
+    }
+
+    double sscanf_ns = bench(parse_gps_info_sscanf);
+    double single_ns = bench(parse_single_pass);
+
+    printf("%zu lines (%zu fixes) from %s\n", corpus.count, fixes, path);
+    printf("sscanf:      %6.1f ns/line\n", sscanf_ns);
+    printf("single pass: %6.1f ns/line (%.1fx faster)\n", single_ns, sscanf_ns / single_ns);
+
+    return host_test_result("bench_gps_parse");
+}
@@ -0,0 +1,87 @@
+#ifndef HOST_TEST_H_
+#define HOST_TEST_H_
+
+// Helpers shared by the host-built unit tests and benchmarks (make host-test).
+// Every test is a standalone program that returns non-zero if a check failed.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+static unsigned host_test_failures;
+
+// Record a failed condition and continue with the next check
+#define CHECK(cond) do { \
+        if (!(cond)) { \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            host_test_failures++; \
+        } \
+    } while (0)
+
+// Monotonic time in nanoseconds
+static inline uint64_t host_now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+// Deterministic pseudo-random numbers (xorshift32), so every run sees the same data
+static inline uint32_t host_rand(uint32_t *state)
+{
+    uint32_t x = *state;
+
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+#define HOST_CORPUS_LINES_MAX   512
+#define HOST_CORPUS_LINE_LEN    128
+
+// Modem lines for the benchmarks, one per line of a text file (tests/data/)
+typedef struct {
+    char text[HOST_CORPUS_LINES_MAX][HOST_CORPUS_LINE_LEN];
+    size_t len[HOST_CORPUS_LINES_MAX];
+    size_t count;
+} host_corpus_t;
+
+// Load a corpus file, without the line terminators. Returns 0 on success, -1 if it cannot be read.
+static inline int host_load_corpus(host_corpus_t *corpus, const char *path)
+{
+    FILE *f = fopen(path, "r");
+
+    if (f == NULL) {
+        printf("Cannot open %s\n", path);
+        return -1;
+    }
+
+    corpus->count = 0;
+    while (corpus->count < HOST_CORPUS_LINES_MAX &&
+           fgets(corpus->text[corpus->count], HOST_CORPUS_LINE_LEN, f) != NULL) {
+        char *line = corpus->text[corpus->count];
+        size_t len = strcspn(line, "\r\n");
+
+        line[len] = '\0';
+        corpus->len[corpus->count++] = len;
+    }
+    fclose(f);
+    return 0;
+}
+
+// Print the summary line and return the exit code of the test
+static inline int host_test_result(const char *name)
+{
+    if (host_test_failures != 0) {
+        printf("%s: %u check(s) FAILED\n", name, host_test_failures);
+        return 1;
+    }
+    printf("%s: all checks passed\n", name);
+    return 0;
+}
+
+#endif  // HOST_TEST_H_
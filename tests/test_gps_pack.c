@@ -0,0 +1,157 @@
+// Round-trip test and benchmark of the packed GPS record (pack_gps()/unpack_gps()).
+//
+// Build and run: make host-test
+
+#include "gps.h"
+#include "host_test.h"
+
+#include <string.h>
+
+#define BENCH_RECORDS   1000000
+
+static const uint8_t month_days[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+
+// Reference CRC-8 (polynomial 0x07, initial value 0x00) to re-seal modified records
+static uint8_t crc8(const uint8_t *buf, uint32_t len)
+{
+    uint8_t crc = 0;
+
+    for (uint32_t i = 0; i < len; i++) {
+        crc ^= buf[i];
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (uint8_t)((crc & 0x80) ? (crc << 1) ^ 0x07 : (crc << 1));
+        }
+    }
+    return crc;
+}
+
+static int gps_equal(const gps_data_t *a, const gps_data_t *b)
+{
+    return a->latitude == b->latitude && a->longitude == b->longitude &&
+           a->year == b->year && a->month == b->month && a->day == b->day &&
+           a->hour == b->hour && a->minute == b->minute && a->second == b->second &&
+           a->altitude == b->altitude && a->speed == b->speed;
+}
+
+// Pack and unpack one fix, which must come back unchanged
+static void check_round_trip(const gps_data_t *in)
+{
+    uint8_t buf[GPS_PACKET_SIZE];
+    gps_data_t out;
+
+    memset(&out, 0, sizeof(out));
+    CHECK(pack_gps(buf, in) == GPS_PACKET_SIZE);
+    CHECK(buf[0] == GPS_PACKET_VERSION);
+    CHECK(unpack_gps(buf, &out) == 0);
+    CHECK(gps_equal(in, &out));
+}
+
+// Every day from 2000 to 2099, at a time of day that moves through the whole range
+static void test_all_days(void)
+{
+    uint32_t rng = 0x2000;
+    gps_data_t data;
+
+    for (uint8_t year = 0; year < 100; year++) {
+        for (uint8_t month = 1; month <= 12; month++) {
+            uint8_t days = month_days[month - 1] + ((month == 2 && (year % 4) == 0) ? 1 : 0);
+
+            for (uint8_t day = 1; day <= days; day++) {
+                data.latitude = (int32_t)(host_rand(&rng) % 1800000001U) - 900000000;
+                data.longitude = (int32_t)(host_rand(&rng) % 3600000001U) - 1800000000;
+                data.year = year;
+                data.month = month;
+                data.day = day;
+                data.hour = (uint8_t)(host_rand(&rng) % 24);
+                data.minute = (uint8_t)(host_rand(&rng) % 60);
+                data.second = (uint8_t)(host_rand(&rng) % 60);
+                data.altitude = (uint16_t)host_rand(&rng);
+                data.speed = (uint16_t)host_rand(&rng);
+                check_round_trip(&data);
+            }
+        }
+    }
+}
+
+// Extreme field values: the ends of the coordinate and time ranges
+static void test_limits(void)
+{
+    const gps_data_t limits[] = {
+        { -900000000, -1800000000, 1, 1, 0, 0, 0, 0, 0, 0 },
+        { 900000000, 1800000000, 31, 12, 99, 23, 59, 59, 65535, 65535 },
+        { INT32_MIN, INT32_MAX, 29, 2, 0, 12, 0, 0, 1, 1 },
+        { 0, 0, 28, 2, 1, 0, 0, 0, 0, 0 },
+    };
+
+    for (size_t i = 0; i < sizeof(limits) / sizeof(limits[0]); i++) {
+        check_round_trip(&limits[i]);
+    }
+}
+
+// Every single-bit error is caught by the CRC, an unknown version is rejected
+static void test_corruption(void)
+{
+    const gps_data_t data = { 481234567, 115678901, 16, 10, 26, 9, 30, 15, 519, 1234 };
+    uint8_t buf[GPS_PACKET_SIZE];
+    gps_data_t out;
+
+    pack_gps(buf, &data);
+    for (uint32_t bit = 0; bit < GPS_PACKET_SIZE * 8; bit++) {
+        buf[bit / 8] ^= (uint8_t)(1U << (bit % 8));
+        CHECK(unpack_gps(buf, &out) == -1);
+        buf[bit / 8] ^= (uint8_t)(1U << (bit % 8));
+    }
+
+    CHECK(crc8(buf, GPS_PACKET_SIZE - 1) == buf[GPS_PACKET_SIZE - 1]);
+    buf[0] = GPS_PACKET_VERSION + 1;
+    buf[GPS_PACKET_SIZE - 1] = crc8(buf, GPS_PACKET_SIZE - 1);
+    CHECK(unpack_gps(buf, &out) == -2);
+}
+
+// Time per pack_gps() and unpack_gps() call
+static void bench_round_trip(void)
+{
+    static gps_data_t points[1024];
+    static uint8_t records[1024][GPS_PACKET_SIZE];
+    uint32_t rng = 0x1234;
+    volatile uint32_t sink = 0;
+    gps_data_t out;
+
+    for (size_t i = 0; i < sizeof(points) / sizeof(points[0]); i++) {
+        points[i].latitude = 481234567 + (int32_t)(host_rand(&rng) % 100000);
+        points[i].longitude = 115678901 + (int32_t)(host_rand(&rng) % 100000);
+        points[i].year = 26;
+        points[i].month = 10;
+        points[i].day = 16;
+        points[i].hour = (uint8_t)(i * 30 / 3600);
+        points[i].minute = (uint8_t)(i * 30 / 60 % 60);
+        points[i].second = (uint8_t)(i * 30 % 60);
+        points[i].altitude = 500 + (uint16_t)(host_rand(&rng) % 50);
+        points[i].speed = (uint16_t)(host_rand(&rng) % 12000);
+    }
+
+    uint64_t start = host_now_ns();
+    for (uint32_t i = 0; i < BENCH_RECORDS; i++) {
+        sink += pack_gps(records[i % 1024], &points[i % 1024]);
+    }
+    uint64_t packed = host_now_ns();
+    for (uint32_t i = 0; i < BENCH_RECORDS; i++) {
+        sink += (uint32_t)unpack_gps(records[i % 1024], &out) + out.second;
+    }
+    uint64_t unpacked = host_now_ns();
+
+    printf("pack_gps:   %6.1f ns/record\n", (double)(packed - start) / BENCH_RECORDS);
+    printf("unpack_gps: %6.1f ns/record\n", (double)(unpacked - packed) / BENCH_RECORDS);
+    printf("record: %d bytes (a +CGPSINFO text line: about 80)\n", GPS_PACKET_SIZE);
+    (void)sink;
+}
+
+int main(void)
+{
+    test_all_days();
+    test_limits();
+    test_corruption();
+    bench_round_trip();
+
+    return host_test_result("test_gps_pack");
+}
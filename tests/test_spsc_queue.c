@@ -0,0 +1,293 @@
+// Unit test and throughput benchmark of the SPSC byte queue (Src/spsc_queue.c).
+//
+// Build and run: make host-test
+
+#include "spsc_queue.h"
+#include "host_test.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <string.h>
+
+#define QUEUE_SIZE      16
+#define BENCH_SIZE      1024            // Queue size of the benchmarks (like the modem RX buffer)
+#define BENCH_BYTES     (32UL << 20)    // Bytes moved per benchmark run
+
+// Start with head/tail just below the 32-bit wrap-around of the free-running counters
+static void queue_init_at(spsc_queue_t *q, uint8_t *buf, uint32_t size, uint32_t start)
+{
+    spsc_queue_init(q, buf, size);
+    q->head = start;
+    q->tail = start;
+}
+
+static void test_init(void)
+{
+    spsc_queue_t q;
+    uint8_t buf[QUEUE_SIZE];
+
+    CHECK(spsc_queue_init(&q, buf, QUEUE_SIZE) == 0);
+    CHECK(spsc_queue_count(&q) == 0);
+    CHECK(spsc_queue_space(&q) == QUEUE_SIZE);
+
+    CHECK(spsc_queue_init(NULL, buf, QUEUE_SIZE) == -1);
+    CHECK(spsc_queue_init(&q, NULL, QUEUE_SIZE) == -1);
+    CHECK(spsc_queue_init(&q, buf, 1) == -1);
+    CHECK(spsc_queue_init(&q, buf, 12) == -1);
+}
+
+// Single bytes: the whole storage is usable, full and empty are reported
+static void test_full_empty(void)
+{
+    spsc_queue_t q;
+    uint8_t buf[QUEUE_SIZE];
+    uint8_t byte;
+
+    queue_init_at(&q, buf, QUEUE_SIZE, UINT32_MAX - 5);
+
+    CHECK(spsc_queue_pop(&q, &byte) == -1);
+    for (uint32_t i = 0; i < QUEUE_SIZE; i++) {
+        CHECK(spsc_queue_push(&q, (uint8_t)i) == 0);
+    }
+    CHECK(spsc_queue_count(&q) == QUEUE_SIZE);
+    CHECK(spsc_queue_space(&q) == 0);
+    CHECK(spsc_queue_push(&q, 0xFF) == -1);
+    CHECK(spsc_queue_push_n(&q, (const uint8_t *)"x", 1) == 0);
+
+    for (uint32_t i = 0; i < QUEUE_SIZE; i++) {
+        CHECK(spsc_queue_pop(&q, &byte) == 0 && byte == (uint8_t)i);
+    }
+    CHECK(spsc_queue_pop(&q, &byte) == -1);
+    CHECK(spsc_queue_pop_n(&q, &byte, 1) == 0);
+    CHECK(spsc_queue_count(&q) == 0);
+}
+
+// Bulk copies that wrap around the end of the storage, at every start offset
+static void test_bulk_wrap(void)
+{
+    spsc_queue_t q;
+    uint8_t buf[QUEUE_SIZE];
+    uint8_t in[QUEUE_SIZE + 4];
+    uint8_t out[QUEUE_SIZE + 4];
+
+    for (uint32_t i = 0; i < sizeof(in); i++) {
+        in[i] = (uint8_t)(0xA0 + i);
+    }
+
+    for (uint32_t start = 0; start < QUEUE_SIZE; start++) {
+        for (uint32_t len = 1; len <= QUEUE_SIZE; len++) {
+            queue_init_at(&q, buf, QUEUE_SIZE, UINT32_MAX - QUEUE_SIZE + 1 + start);
+
+            CHECK(spsc_queue_push_n(&q, in, len) == len);
+            CHECK(spsc_queue_count(&q) == len);
+
+            memset(out, 0, sizeof(out));
+            CHECK(spsc_queue_pop_n(&q, out, sizeof(out)) == len);
+            CHECK(memcmp(in, out, len) == 0);
+            CHECK(spsc_queue_count(&q) == 0);
+        }
+    }
+
+    // Only what fits is queued, only what is there is returned
+    queue_init_at(&q, buf, QUEUE_SIZE, 7);
+    CHECK(spsc_queue_push_n(&q, in, 10) == 10);
+    CHECK(spsc_queue_push_n(&q, &in[10], 10) == QUEUE_SIZE - 10);
+    CHECK(spsc_queue_pop_n(&q, out, 4) == 4);
+    CHECK(memcmp(out, in, 4) == 0);
+    CHECK(spsc_queue_pop_n(&q, out, sizeof(out)) == QUEUE_SIZE - 4);
+    CHECK(memcmp(out, &in[4], QUEUE_SIZE - 4) == 0);
+}
+
+// Zero-copy spans stop at the end of the storage; the rest follows with the next peek
+static void test_span_split(void)
+{
+    spsc_queue_t q;
+    uint8_t buf[QUEUE_SIZE];
+    uint8_t *wspan;
+    const uint8_t *rspan;
+
+    queue_init_at(&q, buf, QUEUE_SIZE, 12);
+
+    // Producer: 4 bytes up to the end, then 8 from the start
+    CHECK(spsc_queue_peek_write(&q, &wspan) == 4 && wspan == &buf[12]);
+    memcpy(wspan, "abcd", 4);
+    spsc_queue_commit_write(&q, 4);
+    CHECK(spsc_queue_peek_write(&q, &wspan) == QUEUE_SIZE - 4 && wspan == &buf[0]);
+    memcpy(wspan, "efghijkl", 8);
+    spsc_queue_commit_write(&q, 8);
+    CHECK(spsc_queue_count(&q) == 12);
+
+    // Consumer: same split, partial commits are allowed
+    CHECK(spsc_queue_peek_read(&q, &rspan) == 4 && memcmp(rspan, "abcd", 4) == 0);
+    spsc_queue_commit_read(&q, 3);
+    CHECK(spsc_queue_peek_read(&q, &rspan) == 1 && rspan[0] == 'd');
+    spsc_queue_commit_read(&q, 1);
+    CHECK(spsc_queue_peek_read(&q, &rspan) == 8 && memcmp(rspan, "efghijkl", 8) == 0);
+    spsc_queue_commit_read(&q, 8);
+    CHECK(spsc_queue_peek_read(&q, &rspan) == 0);
+
+    // A full queue has no free span, the write span is limited by the unread data
+    queue_init_at(&q, buf, QUEUE_SIZE, 0);
+    CHECK(spsc_queue_peek_write(&q, &wspan) == QUEUE_SIZE);
+    spsc_queue_commit_write(&q, QUEUE_SIZE);
+    CHECK(spsc_queue_peek_write(&q, &wspan) == 0);
+    spsc_queue_commit_read(&q, 5);
+    CHECK(spsc_queue_peek_write(&q, &wspan) == 5 && wspan == &buf[0]);
+}
+
+static void test_discard(void)
+{
+    spsc_queue_t q;
+    uint8_t buf[QUEUE_SIZE];
+    uint8_t byte;
+
+    queue_init_at(&q, buf, QUEUE_SIZE, UINT32_MAX);
+    spsc_queue_push_n(&q, (const uint8_t *)"0123456789", 10);
+    spsc_queue_discard(&q);
+    CHECK(spsc_queue_count(&q) == 0);
+    CHECK(spsc_queue_pop(&q, &byte) == -1);
+    CHECK(spsc_queue_push(&q, 'z') == 0);
+    CHECK(spsc_queue_pop(&q, &byte) == 0 && byte == 'z');
+}
+
+// Producer and consumer in two threads: every byte arrives once and in order
+typedef struct {
+    spsc_queue_t q;
+    uint32_t chunk;         // Bytes per push_n/pop_n call, 1: push/pop
+    unsigned long errors;
+} bench_ctx_t;
+
+static void *bench_producer(void *arg)
+{
+    bench_ctx_t *ctx = arg;
+    uint8_t data[256];
+    unsigned long sent = 0;
+
+    while (sent < BENCH_BYTES) {
+        uint32_t len = ctx->chunk;
+
+        for (uint32_t i = 0; i < len; i++) {
+            data[i] = (uint8_t)(sent + i);
+        }
+        // Full: let the consumer run (the host may have a single CPU)
+        if (len == 1) {
+            while (spsc_queue_push(&ctx->q, data[0]) != 0) {
+                sched_yield();
+            }
+        } else {
+            uint32_t done = 0;
+            while (done < len) {
+                uint32_t n = spsc_queue_push_n(&ctx->q, &data[done], len - done);
+                if (n == 0) {
+                    sched_yield();
+                }
+                done += n;
+            }
+        }
+        sent += len;
+    }
+    return NULL;
+}
+
+static void bench_consumer(bench_ctx_t *ctx)
+{
+    uint8_t data[256];
+    unsigned long received = 0;
+
+    while (received < BENCH_BYTES) {
+        uint32_t n;
+
+        if (ctx->chunk == 1) {
+            n = (spsc_queue_pop(&ctx->q, data) == 0) ? 1 : 0;
+        } else {
+            n = spsc_queue_pop_n(&ctx->q, data, ctx->chunk);
+        }
+        if (n == 0) {
+            sched_yield();  // Empty
+        }
+        for (uint32_t i = 0; i < n; i++) {
+            if (data[i] != (uint8_t)(received + i)) {
+                ctx->errors++;
+            }
+        }
+        received += n;
+    }
+}
+
+// One context alternately fills and drains the queue (like an ISR and the main loop on one core)
+static void bench_single(uint32_t chunk)
+{
+    static uint8_t buf[BENCH_SIZE];
+    uint8_t data[256];
+    spsc_queue_t q;
+    unsigned long moved = 0;
+    unsigned long errors = 0;
+
+    spsc_queue_init(&q, buf, BENCH_SIZE);
+    memset(data, 0x55, sizeof(data));
+
+    uint64_t start = host_now_ns();
+    while (moved < BENCH_BYTES) {
+        // Three writes per two reads keep the queue partly filled and wrapping
+        for (int i = 0; i < 3; i++) {
+            if (chunk == 1) {
+                spsc_queue_push(&q, data[0]);
+            } else {
+                spsc_queue_push_n(&q, data, chunk);
+            }
+        }
+        for (int i = 0; i < 2; i++) {
+            if (chunk == 1) {
+                moved += (spsc_queue_pop(&q, data) == 0) ? 1 : 0;
+            } else {
+                moved += spsc_queue_pop_n(&q, data, chunk);
+            }
+        }
+        if (spsc_queue_space(&q) < 3 * chunk) {
+            spsc_queue_discard(&q);
+        }
+        errors += (data[0] != 0x55);
+    }
+    uint64_t elapsed = host_now_ns() - start;
+
+    CHECK(errors == 0);
+    printf("1 thread,  %3lu B per call: %7.1f MB/s\n", (unsigned long)chunk,
+           (double)moved * 1000.0 / (double)elapsed);
+}
+
+static void bench_threads(uint32_t chunk)
+{
+    static uint8_t buf[BENCH_SIZE];
+    bench_ctx_t ctx = { .chunk = chunk };
+    pthread_t producer;
+
+    spsc_queue_init(&ctx.q, buf, BENCH_SIZE);
+
+    uint64_t start = host_now_ns();
+    pthread_create(&producer, NULL, bench_producer, &ctx);
+    bench_consumer(&ctx);
+    pthread_join(producer, NULL);
+    uint64_t elapsed = host_now_ns() - start;
+
+    CHECK(ctx.errors == 0);
+    printf("2 threads, %3lu B per call: %7.1f MB/s\n", (unsigned long)chunk,
+           (double)BENCH_BYTES * 1000.0 / (double)elapsed);
+}
+
+int main(void)
+{
+    test_init();
+    test_full_empty();
+    test_bulk_wrap();
+    test_span_split();
+    test_discard();
+
+    bench_single(1);
+    bench_single(16);
+    bench_single(256);
+    bench_threads(1);
+    bench_threads(16);
+    bench_threads(256);
+
+    return host_test_result("test_spsc_queue");
+}
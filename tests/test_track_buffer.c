@@ -0,0 +1,176 @@
+// Unit test of the track point ring (Src/track_buffer.c): both full policies and the release
+// by sequence number after an upload.
+//
+// Build and run: make host-test
+
+#include "track_buffer.h"
+#include "host_test.h"
+
+#define CAPACITY    8
+
+// Points are told apart by their latitude, which holds the number of the push
+static gps_data_t point(uint32_t n)
+{
+    gps_data_t p;
+
+    memset(&p, 0, sizeof(p));
+    p.latitude = (int32_t)n;
+    return p;
+}
+
+static int push(track_buffer_t *tb, uint32_t n)
+{
+    gps_data_t p = point(n);
+
+    return track_buffer_push(tb, &p);
+}
+
+// The ring holds exactly the points first .. first + count - 1, oldest first
+static int holds(const track_buffer_t *tb, uint32_t first, uint16_t count)
+{
+    if (track_buffer_count(tb) != count || track_buffer_peek(tb, count) != NULL) {
+        return 0;
+    }
+    for (uint16_t i = 0; i < count; i++) {
+        const gps_data_t *p = track_buffer_peek(tb, i);
+
+        if (p == NULL || p->latitude != (int32_t)(first + i)) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static void test_overwrite_oldest(void)
+{
+    track_buffer_t tb;
+    gps_data_t storage[CAPACITY];
+
+    track_buffer_init(&tb, storage, CAPACITY, TRACK_OVERWRITE_OLDEST);
+    CHECK(holds(&tb, 0, 0));
+
+    for (uint32_t n = 0; n < CAPACITY; n++) {
+        CHECK(push(&tb, n) == 0);
+    }
+    CHECK(holds(&tb, 0, CAPACITY));
+    CHECK(tb.overwritten == 0);
+
+    // Several laps: the newest CAPACITY points remain
+    for (uint32_t n = CAPACITY; n < 3 * CAPACITY + 3; n++) {
+        CHECK(push(&tb, n) == 0);
+        CHECK(holds(&tb, n + 1 - CAPACITY, CAPACITY));
+        CHECK(track_buffer_oldest(&tb) == n + 1 - CAPACITY);
+    }
+    CHECK(tb.overwritten == 2 * CAPACITY + 3);
+    CHECK(tb.rejected == 0);
+}
+
+static void test_stop_when_full(void)
+{
+    track_buffer_t tb;
+    gps_data_t storage[CAPACITY];
+
+    track_buffer_init(&tb, storage, CAPACITY, TRACK_STOP_WHEN_FULL);
+    for (uint32_t n = 0; n < CAPACITY + 5; n++) {
+        CHECK(push(&tb, n) == ((n < CAPACITY) ? 0 : -1));
+    }
+    CHECK(holds(&tb, 0, CAPACITY));
+    CHECK(tb.rejected == 5);
+    CHECK(tb.overwritten == 0);
+
+    // Releasing makes room again
+    track_buffer_release(&tb, 3);
+    for (uint32_t n = 100; n < 103; n++) {
+        CHECK(push(&tb, n) == 0);
+    }
+    CHECK(push(&tb, 103) == -1);
+    CHECK(track_buffer_peek(&tb, 0)->latitude == 3);
+    CHECK(track_buffer_peek(&tb, CAPACITY - 1)->latitude == 102);
+    CHECK(tb.rejected == 6);
+}
+
+// Upload the oldest points, meanwhile new fixes overwrite some of them: after the upload
+// only the uploaded points that are still there are released, never the newer ones
+static void test_release_after_overwrite(void)
+{
+    track_buffer_t tb;
+    gps_data_t storage[CAPACITY];
+
+    track_buffer_init(&tb, storage, CAPACITY, TRACK_OVERWRITE_OLDEST);
+    for (uint32_t n = 0; n < CAPACITY; n++) {
+        push(&tb, n);
+    }
+
+    // Upload of the oldest 5 points (sequence numbers 0..4) starts
+    uint32_t end_seq = track_buffer_oldest(&tb) + 5;
+
+    // 3 new points arrive during the upload and overwrite points 0..2
+    for (uint32_t n = CAPACITY; n < CAPACITY + 3; n++) {
+        push(&tb, n);
+    }
+    CHECK(holds(&tb, 3, CAPACITY));
+
+    // Only points 3 and 4 are left to release
+    track_buffer_release(&tb, end_seq);
+    CHECK(holds(&tb, 5, CAPACITY - 2));
+    CHECK(tb.overwritten == 3);
+
+    // A release that was overtaken completely changes nothing
+    for (uint32_t n = CAPACITY + 3; n < 2 * CAPACITY + 3; n++) {
+        push(&tb, n);
+    }
+    track_buffer_release(&tb, end_seq + 2);
+    CHECK(holds(&tb, CAPACITY + 3, CAPACITY));
+
+    // Releasing everything empties the ring, releasing again does nothing
+    track_buffer_release(&tb, track_buffer_oldest(&tb) + CAPACITY);
+    CHECK(holds(&tb, 0, 0));
+    track_buffer_release(&tb, track_buffer_oldest(&tb) + CAPACITY);
+    CHECK(holds(&tb, 0, 0));
+    CHECK(push(&tb, 7) == 0);
+    CHECK(holds(&tb, 7, 1));
+}
+
+// Sequence numbers wrap around after 2^32 points
+static void test_sequence_wrap(void)
+{
+    track_buffer_t tb;
+    gps_data_t storage[CAPACITY];
+
+    track_buffer_init(&tb, storage, CAPACITY, TRACK_OVERWRITE_OLDEST);
+    tb.oldest_seq = UINT32_MAX - 2;
+
+    for (uint32_t n = 0; n < CAPACITY + 4; n++) {
+        push(&tb, n);
+    }
+    CHECK(track_buffer_oldest(&tb) == 1);           // 4 points overwritten: UINT32_MAX - 2 + 4
+    CHECK(holds(&tb, 4, CAPACITY));
+    CHECK(tb.overwritten == 4);
+
+    // Upload started before the wrap (end_seq above UINT32_MAX - 3), released after it
+    track_buffer_init(&tb, storage, CAPACITY, TRACK_OVERWRITE_OLDEST);
+    tb.oldest_seq = UINT32_MAX - 3;
+    for (uint32_t n = 0; n < 6; n++) {
+        push(&tb, n);
+    }
+    uint32_t end_seq = track_buffer_oldest(&tb) + 5;    // Wraps to 1
+
+    CHECK(end_seq == 1);
+    track_buffer_release(&tb, end_seq);
+    CHECK(holds(&tb, 5, 1));
+    CHECK(track_buffer_oldest(&tb) == 1);
+
+    // A stale end_seq from before the wrap releases nothing
+    track_buffer_release(&tb, UINT32_MAX - 1);
+    CHECK(holds(&tb, 5, 1));
+}
+
+int main(void)
+{
+    test_overwrite_oldest();
+    test_stop_when_full();
+    test_release_after_overwrite();
+    test_sequence_wrap();
+
+    return host_test_result("test_track_buffer");
+}
@@ -0,0 +1,278 @@
+// Round-trip test of the track batch codec (Src/track_codec.c) and its size per point on
+// synthetic drives at several poll intervals.
+//
+// Build and run: make host-test
+
+#include "track_codec.h"
+#include "host_test.h"
+
+#include <math.h>
+
+#define STREAM_SIZE     4096
+#define DRIVE_POINTS    32          // Points per batch of the firmware (TRACK_UPLOAD_POINTS)
+
+typedef struct {
+    gps_data_t points[TRACK_BATCH_POINTS_MAX];
+    uint32_t count;
+} decoded_t;
+
+static void collect_point(const gps_data_t *point, void *ctx)
+{
+    decoded_t *out = ctx;
+
+    if (out->count < TRACK_BATCH_POINTS_MAX) {
+        out->points[out->count] = *point;
+    }
+    out->count++;
+}
+
+static int gps_equal(const gps_data_t *a, const gps_data_t *b)
+{
+    return a->latitude == b->latitude && a->longitude == b->longitude &&
+           a->year == b->year && a->month == b->month && a->day == b->day &&
+           a->hour == b->hour && a->minute == b->minute && a->second == b->second &&
+           a->altitude == b->altitude && a->speed == b->speed;
+}
+
+static gps_data_t make_point(int32_t latitude, int32_t longitude, uint32_t seconds, uint16_t altitude, uint16_t speed)
+{
+    gps_data_t point;
+
+    point.latitude = latitude;
+    point.longitude = longitude;
+    gps_from_seconds(seconds, &point);
+    point.altitude = altitude;
+    point.speed = speed;
+    return point;
+}
+
+// Encode points into one batch. Returns its length, 0 if a point did not fit.
+static uint32_t encode(uint8_t *buf, uint32_t size, const gps_data_t *points, uint32_t count)
+{
+    track_encoder_t enc;
+
+    track_encoder_init(&enc, buf, size);
+    for (uint32_t i = 0; i < count; i++) {
+        if (track_encoder_add(&enc, &points[i]) != 0) {
+            return 0;
+        }
+    }
+    return track_encoder_finish(&enc);
+}
+
+// Encode and decode points, which must come back unchanged
+static void check_round_trip(const gps_data_t *points, uint32_t count)
+{
+    static uint8_t buf[STREAM_SIZE];
+    static decoded_t out;
+    uint32_t len = encode(buf, sizeof(buf), points, count);
+
+    CHECK(len >= TRACK_BATCH_MIN_LEN);
+    CHECK(buf[0] == TRACK_BATCH_VERSION && buf[1] == count);
+
+    out.count = 0;
+    CHECK(track_decode(buf, len, collect_point, &out) == (int32_t)len);
+    CHECK(out.count == count);
+    for (uint32_t i = 0; i < count && i < out.count; i++) {
+        CHECK(gps_equal(&points[i], &out.points[i]));
+    }
+}
+
+// A drive with moderate steps, also the input of the error tests
+static uint32_t make_drive(gps_data_t *points, uint32_t count, uint32_t interval_s, uint32_t *rng)
+{
+    int32_t latitude = 481234567;
+    int32_t longitude = 115678901;
+    uint32_t seconds = 846000000;
+    uint16_t altitude = 519;
+
+    for (uint32_t i = 0; i < count; i++) {
+        points[i] = make_point(latitude, longitude, seconds, altitude, (uint16_t)(4000 + host_rand(rng) % 400));
+        latitude += (int32_t)(host_rand(rng) % 200) * (int32_t)interval_s - 100 * (int32_t)interval_s;
+        longitude += (int32_t)(host_rand(rng) % 300) * (int32_t)interval_s;
+        seconds += interval_s;
+        altitude = (uint16_t)(altitude + host_rand(rng) % 3 - 1);
+    }
+    return count;
+}
+
+static void test_round_trip(void)
+{
+    static gps_data_t points[TRACK_BATCH_POINTS_MAX];
+    uint32_t rng = 0x2400;
+
+    check_round_trip(points, make_drive(points, 1, 20, &rng));
+    check_round_trip(points, make_drive(points, 2, 1, &rng));
+    check_round_trip(points, make_drive(points, DRIVE_POINTS, 20, &rng));
+    check_round_trip(points, make_drive(points, TRACK_BATCH_POINTS_MAX, 5, &rng));
+}
+
+// Largest steps in every field: pole to pole, date line to date line, 0 to 65535, 2000 to 2099
+static void test_extreme_deltas(void)
+{
+    const uint32_t first = 0;                       // 2000-01-01 00:00:00
+    const uint32_t last = 3155759999U;              // 2099-12-31 23:59:59
+    const gps_data_t points[] = {
+        make_point(-900000000, -1800000000, first, 0, 0),
+        make_point(900000000, 1800000000, last, 65535, 65535),
+        make_point(-900000000, -1800000000, first, 0, 0),
+        make_point(0, 0, last / 2, 32768, 1),
+        make_point(900000000, -1800000000, last, 65535, 0),
+        make_point(-900000000, 1800000000, first, 0, 65535),
+    };
+
+    CHECK(points[1].year == 99 && points[1].month == 12 && points[1].day == 31);
+    check_round_trip(points, sizeof(points) / sizeof(points[0]));
+}
+
+// A batch cut short at any point is malformed, a changed byte is caught by the CRC
+static void test_corruption(void)
+{
+    static gps_data_t points[DRIVE_POINTS];
+    uint8_t buf[STREAM_SIZE];
+    uint32_t rng = 0x2401;
+    uint32_t len = encode(buf, sizeof(buf), points, make_drive(points, DRIVE_POINTS, 20, &rng));
+
+    for (uint32_t cut = 0; cut < len; cut++) {
+        CHECK(track_decode(buf, cut, NULL, NULL) == -1);
+    }
+
+    // Bit 0 of a delta byte leaves the varint structure intact, only the CRC can tell
+    for (uint32_t pos = TRACK_BATCH_HEADER_LEN + GPS_PACKET_SIZE; pos < len; pos++) {
+        decoded_t out = { .count = 0 };
+
+        buf[pos] ^= 0x01;
+        CHECK(track_decode(buf, len, collect_point, &out) == -2);
+        CHECK(out.count == 0);
+        buf[pos] ^= 0x01;
+    }
+    CHECK(track_decode(buf, len, NULL, NULL) == (int32_t)len);
+
+    buf[0] = TRACK_BATCH_VERSION + 1;
+    CHECK(track_decode(buf, len, NULL, NULL) == -3);
+}
+
+// A full batch is reported, the points added so far stay valid
+static void test_full(void)
+{
+    static gps_data_t points[TRACK_BATCH_POINTS_MAX + 1];
+    static uint8_t buf[STREAM_SIZE * 4];
+    track_encoder_t enc;
+    uint32_t rng = 0x2402;
+
+    make_drive(points, TRACK_BATCH_POINTS_MAX + 1, 1, &rng);
+
+    // Buffer: room for the first point only
+    track_encoder_init(&enc, buf, TRACK_BATCH_MIN_LEN);
+    CHECK(track_encoder_add(&enc, &points[0]) == 0);
+    CHECK(track_encoder_add(&enc, &points[1]) == -1);
+    CHECK(track_encoder_finish(&enc) == TRACK_BATCH_MIN_LEN);
+    CHECK(track_decode(buf, TRACK_BATCH_MIN_LEN, NULL, NULL) == TRACK_BATCH_MIN_LEN);
+
+    track_encoder_init(&enc, buf, TRACK_BATCH_MIN_LEN - 1);
+    CHECK(track_encoder_add(&enc, &points[0]) == -1);
+    CHECK(track_encoder_finish(&enc) == 0);
+
+    // Point count: 255 at most
+    track_encoder_init(&enc, buf, sizeof(buf));
+    for (uint32_t i = 0; i < TRACK_BATCH_POINTS_MAX; i++) {
+        CHECK(track_encoder_add(&enc, &points[i]) == 0);
+    }
+    CHECK(track_encoder_add(&enc, &points[TRACK_BATCH_POINTS_MAX]) == -1);
+
+    uint32_t len = track_encoder_finish(&enc);
+    decoded_t out = { .count = 0 };
+
+    CHECK(track_decode(buf, len, collect_point, &out) == (int32_t)len);
+    CHECK(out.count == TRACK_BATCH_POINTS_MAX);
+}
+
+// Several batches back to back, as the server receives them
+static void test_stream(void)
+{
+    static gps_data_t points[3][DRIVE_POINTS];
+    static uint8_t stream[STREAM_SIZE];
+    static decoded_t out;
+    const uint32_t counts[] = { DRIVE_POINTS, 1, 7 };
+    uint32_t rng = 0x2403;
+    uint32_t len = 0;
+
+    for (uint32_t b = 0; b < 3; b++) {
+        make_drive(points[b], counts[b], 10 * (b + 1), &rng);
+        len += encode(&stream[len], sizeof(stream) - len, points[b], counts[b]);
+    }
+
+    out.count = 0;
+    uint32_t pos = 0;
+    for (uint32_t b = 0; b < 3; b++) {
+        uint32_t first = out.count;
+        int32_t rv = track_decode(&stream[pos], len - pos, collect_point, &out);
+
+        CHECK(rv > 0);
+        if (rv <= 0) {
+            return;
+        }
+        pos += (uint32_t)rv;
+        CHECK(out.count - first == counts[b]);
+        for (uint32_t i = 0; i < counts[b]; i++) {
+            CHECK(gps_equal(&points[b][i], &out.points[first + i]));
+        }
+    }
+    CHECK(pos == len);
+}
+
+// Bytes per point of a batch of DRIVE_POINTS on a drive at speed_kmh, polled every interval_s:
+// heading drift, GPS jitter of a few metres, speed and altitude noise
+static double drive_bytes_per_point(uint32_t interval_s, double speed_kmh)
+{
+    static gps_data_t points[DRIVE_POINTS];
+    uint8_t buf[STREAM_SIZE];
+    uint32_t rng = 0x2404 + interval_s;
+    double latitude = 48.1234567;
+    double longitude = 11.5678901;
+    double heading = 1.0;
+    double altitude = 519.0;
+
+    for (uint32_t i = 0; i < DRIVE_POINTS; i++) {
+        double speed = speed_kmh + (double)(host_rand(&rng) % 1000) / 100.0 - 5.0;
+        double metres = speed / 3.6 * interval_s;
+
+        heading += ((double)(host_rand(&rng) % 1000) / 1000.0 - 0.5) * 0.5;
+        altitude += (double)(host_rand(&rng) % 5) - 2.0;
+        latitude += (metres * cos(heading) + (double)(host_rand(&rng) % 5) - 2.0) / 111320.0;
+        longitude += (metres * sin(heading) + (double)(host_rand(&rng) % 5) - 2.0) / (111320.0 * cos(latitude * M_PI / 180.0));
+
+        points[i] = make_point((int32_t)lround(latitude * GPS_COORD_SCALE), (int32_t)lround(longitude * GPS_COORD_SCALE),
+                               846000000U + i * interval_s, (uint16_t)altitude, (uint16_t)(speed * 100.0));
+    }
+
+    uint32_t len = encode(buf, sizeof(buf), points, DRIVE_POINTS);
+
+    check_round_trip(points, DRIVE_POINTS);
+    return (double)len / DRIVE_POINTS;
+}
+
+static void report_size(void)
+{
+    const uint32_t intervals[] = { 1, 5, 10, 20 };     // 20 s: GPS_POLL_INTERVAL_MS of the firmware
+
+    printf("%d points per batch at about 40 km/h:\n", DRIVE_POINTS);
+    for (size_t i = 0; i < sizeof(intervals) / sizeof(intervals[0]); i++) {
+        double bytes = drive_bytes_per_point(intervals[i], 40.0);
+
+        printf("  every %2lu s: %4.1f bytes per point (%.1fx fewer than %d)\n", (unsigned long)intervals[i],
+               bytes, GPS_PACKET_SIZE / bytes, GPS_PACKET_SIZE);
+    }
+}
+
+int main(void)
+{
+    test_round_trip();
+    test_extreme_deltas();
+    test_corruption();
+    test_full();
+    test_stream();
+    report_size();
+
+    return host_test_result("test_track_codec");
+}
@@ -0,0 +1,160 @@
+#!/usr/bin/env python3
+"""Generate the AT response classifier (Src/at_trie.c) from Inc/at_status.def.
+
+Every AT_STATUS("<prefix>", <status>) entry of the .def file becomes a path in a
+prefix trie. The generated at_trie_classify() walks the trie once over the leading
+bytes of a response line and returns the status of the longest matching prefix.
+
+Usage: gen_at_trie.py <at_status.def> <at_trie.c>
+"""
+
+import re
+import sys
+
+ENTRY = re.compile(r'^\s*AT_STATUS\(\s*"((?:[^"\\]|\\.)*)"\s*,\s*(\w+)\s*\)')
+
+
+def parse_def(path):
+    entries = []
+    with open(path, encoding="ascii") as f:
+        for lineno, line in enumerate(f, 1):
+            m = ENTRY.match(line)
+            if m is None:
+                if line.strip().startswith("AT_STATUS"):
+                    sys.exit("%s:%d: malformed AT_STATUS entry" % (path, lineno))
+                continue
+            prefix = m.group(1).encode("ascii").decode("unicode_escape")
+            if not prefix:
+                sys.exit("%s:%d: empty prefix" % (path, lineno))
+            entries.append((prefix, m.group(2), lineno))
+    if not entries:
+        sys.exit("%s: no AT_STATUS entries" % path)
+    return entries
+
+
+def build_trie(entries, path):
+    # Node: [children {char: node index}, status or None]
+    nodes = [[{}, None]]
+    for prefix, status, lineno in entries:
+        node = 0
+        for ch in prefix:
+            children = nodes[node][0]
+            if ch not in children:
+                children[ch] = len(nodes)
+                nodes.append([{}, None])
+            node = children[ch]
+        if nodes[node][1] is not None:
+            sys.exit("%s:%d: duplicate prefix \"%s\"" % (path, lineno, prefix))
+        nodes[node][1] = status
+    return nodes
+
+
+def renumber(nodes):
+    # Breadth-first order keeps the edges of every node in one contiguous run
+    order = [0]
+    for index in order:
+        order.extend(nodes[index][0][ch] for ch in sorted(nodes[index][0]))
+    new_index = {old: new for new, old in enumerate(order)}
+
+    out_nodes = []
+    edge_chars = []
+    edge_next = []
+    labels = {0: ""}
+    for old in order:
+        children, status = nodes[old]
+        first_edge = len(edge_chars)
+        for ch in sorted(children):
+            edge_chars.append(ch)
+            edge_next.append(new_index[children[ch]])
+            labels[children[ch]] = labels[old] + ch
+        out_nodes.append((first_edge, len(children), status, labels[old]))
+    return out_nodes, edge_chars, edge_next
+
+
+def c_char(ch):
+    return "'\\''" if ch == "'" else "'\\\\'" if ch == "\\" else "'%s'" % ch
+
+
+def emit(out_path, def_path, nodes, edge_chars, edge_next):
+    lines = []
+    w = lines.append
+    w("// Generated by tools/gen_at_trie.py from %s - do not edit." % def_path)
+    w("// Prefix trie of the AT response lines: at_trie_classify() walks it once over the")
+    w("// leading bytes of a line and returns the status of the longest matching prefix.")
+    w("")
+    w('#include "at_trie.h"')
+    w("")
+    w("#include <stdint.h>")
+    w("")
+    w("#define AT_TRIE_NODES   %d" % len(nodes))
+    w("#define AT_TRIE_EDGES   %d" % len(edge_chars))
+    w("")
+    w("typedef struct {")
+    w("    uint16_t first_edge;    // Edges of the node: [first_edge, first_edge + edge_count)")
+    w("    uint8_t edge_count;")
+    w("    uint8_t status;         // AtResponseStatus_t of the prefix ending here, or AT_RX_PARTIAL")
+    w("} at_trie_node_t;")
+    w("")
+    w("static const at_trie_node_t at_trie_nodes[AT_TRIE_NODES] = {")
+    for first_edge, count, status, label in nodes:
+        label = label.replace("\\", "\\\\")
+        w("    { %3d, %2d, %-19s },  // \"%s\"" % (first_edge, count, status or "AT_RX_PARTIAL", label))
+    w("};")
+    w("")
+    w("// Character and target node of every edge")
+    w("static const char at_trie_edge_char[AT_TRIE_EDGES] = {")
+    for i in range(0, len(edge_chars), 12):
+        w("    " + " ".join(c_char(ch) + "," for ch in edge_chars[i:i + 12]))
+    w("};")
+    w("")
+    w("static const uint16_t at_trie_edge_next[AT_TRIE_EDGES] = {")
+    for i in range(0, len(edge_next), 12):
+        w("    " + " ".join("%3d," % n for n in edge_next[i:i + 12]))
+    w("};")
+    w("")
+    w("// Classify a single AT-Response line (without terminator)")
+    w("AtResponseStatus_t at_trie_classify(const char *line, size_t len)")
+    w("{")
+    w("    AtResponseStatus_t status = AT_RX_PARTIAL;  // no match, not a status line")
+    w("    uint16_t node = 0;")
+    w("")
+    w("    // Check input parameters")
+    w("    if (line == NULL) {")
+    w("        return AT_INVALID_PARAM;")
+    w("    }")
+    w("")
+    w("    for (size_t i = 0; i < len; i++) {")
+    w("        const at_trie_node_t *n = &at_trie_nodes[node];")
+    w("        uint16_t edge = n->first_edge;")
+    w("        uint16_t end = n->first_edge + n->edge_count;")
+    w("")
+    w("        while (edge < end && at_trie_edge_char[edge] != line[i]) {")
+    w("            edge++;")
+    w("        }")
+    w("        if (edge == end) {")
+    w("            break;      // No longer prefix possible")
+    w("        }")
+    w("")
+    w("        node = at_trie_edge_next[edge];")
+    w("        if (at_trie_nodes[node].status != AT_RX_PARTIAL) {")
+    w("            status = (AtResponseStatus_t)at_trie_nodes[node].status;")
+    w("        }")
+    w("    }")
+    w("")
+    w("    return status;")
+    w("}")
+    with open(out_path, "w", encoding="ascii", newline="\n") as f:
+        f.write("\n".join(lines) + "\n")
+
+
+def main():
+    if len(sys.argv) != 3:
+        sys.exit("usage: %s <at_status.def> <at_trie.c>" % sys.argv[0])
+    def_path, out_path = sys.argv[1], sys.argv[2]
+    entries = parse_def(def_path)
+    nodes, edge_chars, edge_next = renumber(build_trie(entries, def_path))
+    emit(out_path, def_path, nodes, edge_chars, edge_next)
+
+
+if __name__ == "__main__":
+    main()
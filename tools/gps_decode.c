@@ -0,0 +1,83 @@
+// Host-side decoder for the GPS data uploaded by the tracker. Reads concatenated packed
+// records (pack_gps()) and track batches (track_codec.h) from a file or stdin, e.g. the
+// application/octet-stream body received by the server, and prints one CSV line per point.
+// The first byte of each record or batch (its version) tells them apart.
+//
+// Build: make host-tools
+// Usage: gps_decode [file]
+
+#include "gps.h"
+#include "track_codec.h"
+
+#include <stdio.h>
+
+#define INPUT_MAX   65536
+
+static uint8_t input[INPUT_MAX];
+static unsigned long points;
+
+// Print one point as CSV line
+static void print_point(const gps_data_t *data, void *ctx)
+{
+    char lat[GPS_COORD_STR_LEN];
+    char lon[GPS_COORD_STR_LEN];
+    (void)ctx;
+
+    printf("%lu,%s,%s,20%02u-%02u-%02u,%02u:%02u:%02u,%u,%u.%02u\n", points++,
+           coord_to_str(lat, data->latitude), coord_to_str(lon, data->longitude),
+           data->year, data->month, data->day, data->hour, data->minute, data->second,
+           data->altitude, data->speed / 100, data->speed % 100);
+}
+
+int main(int argc, char *argv[])
+{
+    FILE *in = stdin;
+    size_t len;
+    size_t pos = 0;
+
+    if (argc > 2) {
+        fprintf(stderr, "Usage: %s [file]\n", argv[0]);
+        return 2;
+    }
+    if (argc == 2) {
+        in = fopen(argv[1], "rb");
+        if (in == NULL) {
+            perror(argv[1]);
+            return 2;
+        }
+    }
+
+    len = fread(input, 1, sizeof(input), in);
+    if (in != stdin) {
+        fclose(in);
+    }
+
+    printf("index,latitude,longitude,date,time,altitude_m,speed_kmh\n");
+
+    while (pos < len) {
+        if (input[pos] == GPS_PACKET_VERSION && len - pos >= GPS_PACKET_SIZE) {
+            gps_data_t data;
+
+            if (unpack_gps(&input[pos], &data) != 0) {
+                fprintf(stderr, "Record at byte %lu: CRC mismatch.\n", (unsigned long)pos);
+                return 1;
+            }
+            print_point(&data, NULL);
+            pos += GPS_PACKET_SIZE;
+        } else if (input[pos] == TRACK_BATCH_VERSION) {
+            int32_t rv = track_decode(&input[pos], (uint32_t)(len - pos), print_point, NULL);
+
+            if (rv < 0) {
+                fprintf(stderr, "Batch at byte %lu: %s.\n", (unsigned long)pos,
+                        (rv == -2) ? "CRC mismatch" : "truncated or malformed");
+                return 1;
+            }
+            pos += (size_t)rv;
+        } else {
+            fprintf(stderr, "Unknown or incomplete data at byte %lu.\n", (unsigned long)pos);
+            return 1;
+        }
+    }
+
+    return 0;
+}